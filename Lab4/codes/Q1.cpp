@@ -1,7 +1,36 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -13,15 +42,109 @@ using ll = long long;
 // INFINITY
 const ll INF = 1e18;
 
-// Represents an edge of the network
-class Edge {
+// Default arity of the heap used by the Dijkstra algorithm
+#define DEFAULT_HEAP_ARITY 4
+
+// Number of source nodes given to every thread in a batch of the all-sources mode
+#define SOURCES_PER_THREAD 4
+
+// The priority queues that can be used by the Dijkstra algorithm to pick the next closest node
+enum class QueueType {
+    LINEAR,  // Linear scan over all the unvisited nodes, O(V^2)
+    HEAP,    // Indexed d-ary heap with decrease-key, O(E log V)
+    DIAL     // Dial's circular bucket queue over the bounded edge weights, O(E + V * MAX_EDGE_WEIGHT)
+};
+
+// The kernels that can compute the shortest paths from a single source node
+enum class SpfKernel {
+    DIJKSTRA,  // Sequential Dijkstra algorithm with the chosen priority queue
+    DELTA      // Parallel delta-stepping algorithm over buckets of tentative distances
+};
+
+// Minimum number of adjacency list entries of a graph for the delta-stepping kernel to be used
+// Smaller graphs run the sequential kernel, as the threads would mostly wait at the barriers
+#define DELTA_MIN_ENTRIES (1 << 16)
+
+// Number of frontier nodes taken at once by a thread of the delta-stepping kernel
+#define DELTA_BLOCK_SIZE 64
+
+// Default number of landmarks of the A* search
+#define DEFAULT_LANDMARKS 8
+
+// The algorithms that can answer the point-to-point queries
+enum class QueryAlgo {
+    FULL,   // Full single source Dijkstra algorithm from the source node
+    BIDIR,  // Bidirectional Dijkstra algorithm
+    ALT     // A* search with landmark lower bounds
+};
+
+// The formats in which the routing tables are written
+enum class OutputFormat {
+    PATHS,   // Human-readable table with the least cost path of every node
+    CSV,     // Next-hop table of CSV lines `source,destination,distance,next_hop`
+    BINARY   // Next-hop table of binary arrays of the distances and the next hops
+};
+
+// Default number of shortest path trees cached by the server
+#define DEFAULT_CACHE_TREES 64
+
+// Command line options of the program, given as `--name=value` anywhere among the arguments
+class Options {
    public:
-    // The vertices `u` and `v` of an edge and the weight `w` of that edge
-    string u, v;
-    ll w;
+    // The priority queue used by the Dijkstra algorithm and the arity of the heap
+    QueueType queue = QueueType::HEAP;
+    ll arity = DEFAULT_HEAP_ARITY;
 
-    // Constructor
-    Edge(string u, string v, ll w) : u{u}, v{v}, w{w} {}
+    // The kernel computing the shortest paths from a single source node, and the bucket width of the delta-stepping
+    // kernel (0 for the mean edge weight)
+    SpfKernel kernel = SpfKernel::DIJKSTRA;
+    ll delta = 0;
+
+    // The number of threads to use, all the hardware threads by default
+    ll threads = max(1U, thread::hardware_concurrency());
+
+    // Whether to compute the routing tables of all the nodes instead of a single source node
+    bool allSources = false;
+
+    // Whether to print all the equal-cost least cost paths of every node instead of a single one
+    bool ecmp = false;
+
+    // The format of the routing tables
+    OutputFormat output = OutputFormat::PATHS;
+
+    // The file of link cost updates to apply to the shortest path tree, if any
+    string updates;
+
+    // The file of point-to-point queries to answer, if any, the algorithm answering them and the number of landmarks
+    string queries;
+    QueryAlgo queryAlgo = QueryAlgo::ALT;
+    ll landmarks = DEFAULT_LANDMARKS;
+
+    // The number of least cost loopless paths found for every query
+    ll kPaths = 1;
+
+    // The file to save the contraction hierarchy to, and the file to load it from for answering the queries
+    string chBuild, ch;
+
+    // The file to save the snapshot of the graph to, and whether to verify the snapshots being loaded
+    string saveSnapshot;
+    bool verifySnapshot = false;
+
+    // Whether to build the graph of a text file of edges on the disk with an external sort, keeping only
+    // the state of the nodes in the memory while the adjacency lists are read from the mapped snapshot
+    bool semiExternal = false;
+
+    // Whether to print the time taken by every phase of the run to the standard error
+    bool timing = false;
+
+    // Whether to report the phase times, the peak memory and the kernel counters as JSON, and the file
+    // to write them to ("-" for the standard error)
+    bool stats = false;
+    string statsFile = "-";
+
+    // The address to serve the routing requests on, if any, and the number of shortest path trees cached by the server
+    string serve;
+    ll cacheTrees = DEFAULT_CACHE_TREES;
 };
 
 // Takes a string as input and convert it to a long long integer
@@ -40,236 +163,3421 @@ ll stringToLong(const string &s) {
     return isNeg ? -ans : ans;
 }
 
-// Reads input edges from the given filename
-// and fills it inside the input vector of edges
-void readEdges(string fileName, vector<Edge> &edges) {
-    // The `ifstream` object to read an input file
-    ifstream inFile{fileName, ios::in};
+// Calls `fn(i, t)` for every `i` from 0 to `n - 1` using up to `numThreads` threads, `t` being the index
+// of the calling thread. The indices are handed out one at a time, so the threads stay busy even if
+// the calls take uneven time
+template <typename Function>
+void parallelFor(ll n, ll numThreads, Function fn) {
+    atomic<ll> next{0};
+    auto worker = [&](ll t) {
+        for (ll i = next++; i < n; i = next++) fn(i, t);
+    };
 
-    // If the file was not able to open, exit with failure status
-    if (!inFile) {
-        std::cout << "File '" << fileName << "' could not be opened!\n";
-        exit(EXIT_FAILURE);
+    // The calling thread works as well
+    vector<thread> pool;
+    for (ll t = 1; t < min(n, numThreads); ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (thread &th : pool) th.join();
+}
+
+// Wall clock times of the phases of a run, printed to the standard error with `--timing`
+class PhaseTimer {
+   public:
+    // The name of every phase ended so far and its time in microseconds
+    vector<pair<string, ll>> phases;
+
+    // Constructor, the first phase starts now
+    PhaseTimer() : last{chrono::steady_clock::now()} {}
+
+    // Ends the current phase with the given name, the next phase starting now
+    void lap(const string &name) {
+        auto now = chrono::steady_clock::now();
+        phases.emplace_back(name, chrono::duration_cast<chrono::microseconds>(now - last).count());
+        last = now;
     }
 
-    // The vertices and weight of an edge
-    string u, v, w;
-    ll wl;
-    // Read from the file till we are able to read the input
-    while (inFile >> u >> v >> w) {
-        try {
-            // Try converting weight to long long integer
-            wl = stringToLong(w);
+    // Prints the time of every phase to the given stream
+    void report(ostream &os) const {
+        for (const auto &[name, us] : phases) os << "Phase " << name << ": " << us << " us\n";
+    }
 
-            // For this question weight should be a positive integer
-            // less than 10000
-            if (wl <= 0 || wl >= MAX_EDGE_WEIGHT) throw exception();
-        } catch (exception &e) {
-            std::cout << "The weight of an edge between two nodes should be a positive integer less than 10,000, but got '" << w << "'\n";
-            inFile.close();  // Close the file
-            exit(EXIT_FAILURE);
+    // Prints the time of every phase as the members of a JSON object, followed by their total
+    void json(ostream &os) const {
+        ll total = 0;
+        os << "\"phases_us\": {";
+        for (size_t i = 0; i < phases.size(); ++i) {
+            os << (i == 0 ? "" : ", ") << "\"" << phases[i].first << "\": " << phases[i].second;
+            total += phases[i].second;
         }
+        os << "}, \"total_us\": " << total;
+    }
+
+   private:
+    // The time at which the current phase started
+    chrono::steady_clock::time_point last;
+};
+
+// Size of every block of the arena holding the node names
+#define NAME_BLOCK_SIZE (1 << 20)
+
+// Interning table assigning consecutive integers starting from 0 to the names of the nodes
+// Every distinct name is copied once into an arena of large character blocks, so no name needs
+// its own heap allocation. Names are looked up in an open-addressing hash table with linear probing,
+// and the reverse direction is a flat vector of views into the arena
+class NodeTable {
+   public:
+    // The name of every node, indexed by the integer assigned to it
+    vector<string_view> names;
+
+    // Constructor, the names are copied into the arena of the table unless `copyNames` is false
+    // in which case the viewed names must outlive the table
+    NodeTable(bool copyNames = true) : slots(16, EMPTY_SLOT), blockUsed{NAME_BLOCK_SIZE}, copyNames{copyNames} {}
 
-        // Create and push the edge into the vector
-        edges.push_back(Edge(u, v, wl));
+    // The number of names present in the table
+    ll size() const {
+        return names.size();
     }
 
-    // Close the input file
-    inFile.close();
-}
+    // Returns the name of the node `i`, or "-" if no name was assigned to it
+    string_view name(ll i) const {
+        return i < (ll)names.size() ? names[i] : "-";
+    }
 
-// Builds a graph from the given set of edges
-// Maps the string name of each node to normalized integer numbers starting from 0
-// and maintains a reverse map of the above. Returns the integer assigned to the source node
-ll buildGraph(ll numNodes, const vector<Edge> &edges, map<string, ll> &nti, map<ll, string> &itn, string sourceNode, vector<vector<pair<ll, ll>>> &gr) {
-    const ll sNode = 0;  // Give source node as integer 0
-    nti[sourceNode] = sNode;
-    itn[sNode] = sourceNode;
+    // Returns the integer assigned to the given name, or -1 if it is not present in the table
+    ll find(string_view name) const {
+        uint64_t h = hash(name);
+        for (size_t i = h & (slots.size() - 1);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i] == EMPTY_SLOT) return -1;
+            if (matches(slots[i], h, name)) return (uint32_t)slots[i];
+        }
+    }
 
-    // Initialize the adjacency list for each node in the graph
-    gr.assign(numNodes, vector<pair<ll, ll>>());
+    // Returns the integer assigned to the given name, assigning it the next integer if it is not present
+    ll intern(string_view name) {
+        return insert(name, copyNames);
+    }
 
-    ll num = 1;  // The integer assigned to each string name of the node
+    // Same as `intern`, but the name is never copied, so the viewed name must outlive the table
+    ll internView(string_view name) {
+        return insert(name, false);
+    }
 
-    // Loop over all the edges
-    for (const Edge &e : edges) {
-        ll ui, vi;                  // The integers for both the vertices of the edge
-        auto uItr = nti.find(e.u);  // Try finding the string name in the map
-        if (uItr != nti.end()) {
-            // If it already exists, take that integer
-            ui = uItr->second;
-        } else {
-            // Else assign it a new integer and update the map
-            ui = num++;
-            nti[e.u] = ui;
-            itn[ui] = e.u;
+    // Grows the hash table ahead of interning the given number of names
+    void reserve(ll numNames) {
+        while (2 * numNames > (ll)slots.size()) grow();
+    }
+
+   private:
+    // Every slot keeps the upper 32 bits of the hash of the name along with the integer assigned to it
+    static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+    static constexpr uint64_t HASH_MASK = 0xffffffff00000000ULL;
+
+    // The hash table of the names
+    vector<uint64_t> slots;
+
+    // The blocks of the arena and the number of characters used in the last block
+    vector<unique_ptr<char[]>> blocks;
+    size_t blockUsed;
+
+    // Whether the names are copied into the arena or only viewed
+    bool copyNames;
+
+    // FNV-1a hash of the given name
+    static uint64_t hash(string_view name) {
+        uint64_t h = 14695981039346656037ULL;
+        for (char c : name) {
+            h ^= (unsigned char)c;
+            h *= 1099511628211ULL;
         }
+        return h;
+    }
 
-        auto vItr = nti.find(e.v);  // Try finding the string name in the map
-        if (vItr != nti.end()) {
-            // If it already exists, take that integer
-            vi = vItr->second;
-        } else {
-            // Else assign it a new integer and update the map
-            vi = num++;
-            nti[e.v] = vi;
-            itn[vi] = e.v;
+    // Whether the given slot holds the given name having the given hash
+    bool matches(uint64_t slot, uint64_t h, string_view name) const {
+        return (slot & HASH_MASK) == (h & HASH_MASK) && names[(uint32_t)slot] == name;
+    }
+
+    // Returns the integer assigned to the given name, assigning it the next integer if it is not present
+    // The name of a new node is copied into the arena if `copy` is true
+    ll insert(string_view name, bool copy) {
+        // Keep the load factor of the hash table below one half
+        if (2 * (names.size() + 1) > slots.size()) grow();
+
+        uint64_t h = hash(name);
+        size_t i = h & (slots.size() - 1);
+        for (; slots[i] != EMPTY_SLOT; i = (i + 1) & (slots.size() - 1)) {
+            if (matches(slots[i], h, name)) return (uint32_t)slots[i];
         }
 
-        // The provided input number of nodes and number of distinct nodes found in the
-        // input file should be same
-        if (num > numNodes) {
-            std::cout << "Number of distinct nodes in the input file is greater than the given number of nodes\n";
-            exit(EXIT_FAILURE);
+        // Copy the name into the arena and assign it the next integer
+        ll id = names.size();
+        names.emplace_back(copy ? store(name) : name);
+        slots[i] = (h & HASH_MASK) | id;
+        return id;
+    }
+
+    // Doubles the size of the hash table and re-inserts all the names
+    void grow() {
+        vector<uint64_t> old(2 * slots.size(), EMPTY_SLOT);
+        old.swap(slots);
+        for (uint64_t slot : old) {
+            if (slot == EMPTY_SLOT) continue;
+            size_t i = hash(names[(uint32_t)slot]) & (slots.size() - 1);
+            while (slots[i] != EMPTY_SLOT) i = (i + 1) & (slots.size() - 1);
+            slots[i] = slot;
         }
+    }
 
-        // Push the edge into the adjacency list of both the vertices
-        gr[ui].emplace_back(make_pair(vi, e.w));
-        gr[vi].emplace_back(make_pair(ui, e.w));
+    // Copies the given name into the arena and returns the view of the copy
+    string_view store(string_view name) {
+        if (blockUsed + name.size() > NAME_BLOCK_SIZE) {
+            // Start a new block, names longer than a block get a block of their own
+            blocks.emplace_back(new char[max((size_t)NAME_BLOCK_SIZE, name.size())]);
+            blockUsed = 0;
+        }
+        char *dst = blocks.back().get() + blockUsed;
+        copy(name.begin(), name.end(), dst);
+        blockUsed += name.size();
+        return string_view(dst, name.size());
     }
+};
 
-    // Return the integer assigned to the source node
-    return sNode;
-}
+// Minimum number of bytes of the input file given to every thread reading it
+#define MIN_CHUNK_SIZE (1 << 20)
 
-// Performs the Dijkstra algorithm on the given graph from the source node
-// fills the distance and the parent vectors from the source node
-void dijkstra(ll numNodes, ll sourceNode, vector<ll> &distance, vector<ll> &parent, const vector<vector<pair<ll, ll>>> &gr) {
-    // Keep track of which nodes have been visited so far. Initially all the nodes are not visited
-    vector<bool> visited(numNodes, false);
+// The edges read from one chunk of lines of the input file
+class EdgeChunk {
+   public:
+    // The names of the nodes in the order of their first appearance in the chunk
+    // These are views into the input file, so this table does not copy them
+    NodeTable nodes{false};
 
-    // Initialize the distance of all the nodes from the source node as INFINITY
-    distance.assign(numNodes, INF);
-    // Initialize the parent of all the nodes as -1 in their shortest path from the source node
-    parent.assign(numNodes, -1);
+    // The vertices (as integers of the above table) and the weight of every edge, three entries per edge
+    vector<uint32_t> edges;
 
-    distance[sourceNode] = 0;  // Distance of the source node from itself is zero
+    // The number of lines in the chunk
+    ll numLines = 0;
 
-    // Iterate over all the nodes
-    for (ll i = 0; i < numNodes; ++i) {
-        // Find the node having the minimum distance among all the unvisited nodes
-        int u = -1;
-        for (int j = 0; j < numNodes; ++j) {
-            if (!visited[j] && (u == -1 || distance[j] < distance[u])) {
-                u = j;
+    // The first invalid line of the chunk (-1 if there is none), and the invalid token or line
+    ll errLine = -1;
+    string_view errToken;
+    bool badWeight = false;
+
+    // Returns the number of edges in the chunk
+    size_t size() const {
+        return edges.size() / 3;
+    }
+};
+
+// The input file mapped into the memory along with the edges read from it
+// The file is split at line boundaries into chunks which are tokenized in place by separate threads
+class EdgeFile {
+   public:
+    // The edges read from every chunk of the file, in the order of the chunks in the file
+    vector<EdgeChunk> chunks;
+
+    // Constructor
+    EdgeFile() : data{nullptr}, size{0}, mapped{false} {}
+
+    // Unmaps the file, if it was mapped into the memory
+    ~EdgeFile() {
+        if (mapped) munmap((void *)data, size);
+    }
+
+    // Opens and maps the given file into the memory. Files that can not be mapped are read into a buffer
+    // Returns false if the file could not be opened
+    bool open(const string &fileName) {
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd == -1) return false;
+
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                // The file is read sequentially from multiple positions, so ask for an aggressive readahead
+                madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                data = (const char *)addr;
+                size = st.st_size;
+                mapped = true;
             }
         }
 
-        // It means that all the remaining unvisited nodes are unreachable from the source node
-        if (distance[u] == INF) break;
+        if (!mapped) {
+            // Read the whole file, if it is not a regular file or could not be mapped
+            char buf[1 << 16];
+            ssize_t n;
+            while ((n = read(fd, buf, sizeof(buf))) > 0) buffer.insert(buffer.end(), buf, buf + n);
+            data = buffer.data();
+            size = buffer.size();
+        }
+        close(fd);
+        return true;
+    }
 
-        visited[u] = true;  // Mark this node as visited
+    // Tokenizes the file one block of about `blockSize` bytes at a time, ending at a line boundary, so that only
+    // the edges of a single block are kept in the given chunk. Calls `fn(chunk)` with the edges of every block
+    // The names of all the blocks are interned into the table of the chunk, which should copy them, as
+    // the pages of a mapped file are released once their block is done
+    template <typename Function>
+    void tokenizeBlocks(size_t blockSize, EdgeChunk &chunk, Function fn) {
+        size_t released = 0, pageSize = sysconf(_SC_PAGESIZE);
+        for (size_t pos = 0; pos < size;) {
+            size_t end = min(size, pos + blockSize);
+            const char *nl = (const char *)memchr(data + end - 1, '\n', size - end + 1);
+            end = nl == nullptr ? size : nl - data + 1;
 
-        // Iterate over all the edges of the current node
-        for (const auto &e : gr[u]) {
-            // The neighbor node and the edge weight
-            ll v = e.first, w = e.second;
-            // If the neighbor node can be reached from the source node in less distance
-            // when using the current node, then update the distance of the neighbor node
-            // and marks its parent as the current node on the least cost path
-            if (distance[u] + w < distance[v]) {
-                distance[v] = distance[u] + w;
-                parent[v] = u;
+            chunk.edges.clear();
+            chunk.numLines = 0;
+            tokenizeChunk(data + pos, data + end, chunk);
+            fn(chunk);
+            pos = end;
+
+            if (mapped && pos / pageSize * pageSize > released) {
+                madvise((char *)data + released, pos / pageSize * pageSize - released, MADV_DONTNEED);
+                released = pos / pageSize * pageSize;
             }
         }
     }
-}
 
-// Generic function to pretty print any input with defined width, alignment and fill character
-template <typename T>
-void prettyPrint(const T &res, ll width, std::ios_base &(*positioning)(std::ios_base &) = std::left, char fillChar = ' ') {
-    ios init(NULL);
-    // copying the default `cout` formatting
-    init.copyfmt(std::cout);
-    // pretty printing the input
-    std::cout << setfill(fillChar) << setw(width) << positioning << res;
-    // resetting the default `cout` formatting
-    std::cout.copyfmt(init);
-}
+    // Splits the file at line boundaries into chunks of almost equal size, one for each thread
+    // and tokenizes all the chunks in parallel
+    void tokenize(ll numThreads) {
+        ll numChunks = max(1LL, min(numThreads, (ll)(size / MIN_CHUNK_SIZE)));
+        vector<size_t> bounds{0};
+        for (ll c = 1; c < numChunks; ++c) {
+            // The chunk ends after the first newline character at or after its target end
+            size_t pos = max(bounds.back(), (size_t)(size * c / numChunks));
+            const char *nl = (const char *)memchr(data + pos, '\n', size - pos);
+            if (nl == nullptr) break;
+            bounds.emplace_back(nl - data + 1);
+        }
+        bounds.emplace_back(size);
 
-// Pretty prints the results obtained from the Dijkstra algorithm
-// Output the least cost path from source node to every node in the network along with the path price
-void printResults(ll sNode, const vector<ll> &distance, const vector<ll> &parent, const map<ll, string> &itn) {
-    std::cout << "Distance of Nodes from the source node: " << (itn.find(sNode))->second << "\n\n";
-    prettyPrint("Node", 15);
-    std::cout << "  |  ";
-    prettyPrint("Path Price", 15);
-    std::cout << "  |  ";
-    std::cout << "Shortest Path\n";
-    prettyPrint("\n", 75, std::right, '=');
+        chunks.resize(bounds.size() - 1);
+        parallelFor(chunks.size(), numThreads, [&](ll c, ll) {
+            tokenizeChunk(data + bounds[c], data + bounds[c + 1], chunks[c]);
+        });
+    }
 
-    // Iterating all the nodes in the network
-    for (ll i = 0; i < distance.size(); ++i) {
-        // Convert the node from integer naming to original string name
-        auto currNode = itn.find(i);
-
-        // If the node is not present in the map, then it does not have any edge in the network
-        // So, its name is unkown
-        prettyPrint(currNode != itn.end() ? currNode->second : "-", 15);
-        std::cout << "  |  ";
-
-        // If node is unreachable from the source node
-        if (distance[i] == INF) {
-            prettyPrint("INF", 15);
-            std::cout << "  |  ";
-            std::cout << "-";
-        } else {
-            prettyPrint(distance[i], 15);
-            std::cout << "  |  ";
+   private:
+    // The contents of the file, and whether they are mapped into the memory or read into the buffer
+    const char *data;
+    size_t size;
+    bool mapped;
+    vector<char> buffer;
+
+    // Whether the given character separates the tokens of a line
+    static bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Reads the edges from the lines between `p` and `end`, every line having the vertices and the weight of an edge
+    // Stops at the first invalid line, recording it in the chunk
+    static void tokenizeChunk(const char *p, const char *end, EdgeChunk &chunk) {
+        chunk.edges.reserve((end - p) / 8);
+        while (p < end) {
+            const char *eol = (const char *)memchr(p, '\n', end - p);
+            if (eol == nullptr) eol = end;
 
-            // Extracting the path by going from node to its parent till we reach the source node
-            vector<string> path;
-            for (ll v = i; v != -1; v = parent[v]) {
-                path.emplace_back((itn.find(v))->second);
+            // Split the line into at most four tokens, the fourth one being an error
+            string_view tokens[4];
+            int numTokens = 0;
+            for (const char *q = p; numTokens < 4;) {
+                while (q < eol && isBlank(*q)) ++q;
+                if (q == eol) break;
+                const char *start = q;
+                while (q < eol && !isBlank(*q)) ++q;
+                tokens[numTokens++] = string_view(start, q - start);
             }
-            // Printing the least cost path
-            for (ll j = path.size() - 1; j >= 0; --j) {
-                std::cout << path[j];
-                if (j != 0) std::cout << " -> ";
+
+            if (numTokens == 3) {
+                // Try converting weight to integer
+                const string_view &w = tokens[2];
+                ll wl = 0;
+                auto res = from_chars(w.data(), w.data() + w.size(), wl);
+
+                // For this question weight should be a positive integer
+                // less than 10000
+                if (res.ec != errc() || res.ptr != w.data() + w.size() || wl <= 0 || wl >= MAX_EDGE_WEIGHT) {
+                    chunk.errLine = chunk.numLines;
+                    chunk.errToken = w;
+                    chunk.badWeight = true;
+                    return;
+                }
+
+                chunk.edges.emplace_back(chunk.nodes.intern(tokens[0]));
+                chunk.edges.emplace_back(chunk.nodes.intern(tokens[1]));
+                chunk.edges.emplace_back((uint32_t)wl);
+            } else if (numTokens != 0) {
+                // Every non-empty line should have exactly three tokens
+                chunk.errLine = chunk.numLines;
+                chunk.errToken = string_view(p, eol - p);
+                return;
             }
+
+            ++chunk.numLines;
+            p = eol + 1;
         }
-        std::cout << "\n";
     }
+};
+
+// Exits with failure status reporting the invalid line of the chunk, if it has one
+// `line` is the line number of the first line of the chunk in the file
+void checkChunk(const EdgeChunk &chunk, ll line) {
+    if (chunk.errLine == -1) return;
+    if (chunk.badWeight) {
+        std::cout << "The weight of an edge between two nodes should be a positive integer less than 10,000, but got '" << chunk.errToken << "'\n";
+    } else {
+        std::cout << "Every line of the input file should be an edge as '<u> <v> <w>', but line " << line + chunk.errLine << " is '" << chunk.errToken << "'\n";
+    }
+    exit(EXIT_FAILURE);
 }
 
-int main(int argc, char const *argv[]) {
-    // This program requires three arguments from the command line
-    if (argc != 4) {
-        std::cout << "Expected 3 arguments, but received " << argc - 1 << "\n";
-        std::cout << "Please provide the arguments as follows: ./<prog_name.out> <numNodes> <sourceNode> <fileName>";
-        return EXIT_FAILURE;
+// Reads input edges from the given filename
+// and fills them inside the chunks of the input edge file
+void readEdges(string fileName, ll numThreads, EdgeFile &file) {
+    // If the file was not able to open, exit with failure status
+    if (!file.open(fileName)) {
+        std::cout << "File '" << fileName << "' could not be opened!\n";
+        exit(EXIT_FAILURE);
     }
 
-    // Getting the number of nodes in the network
-    ll numNodes;
-    try {
-        numNodes = stringToLong(argv[1]);
-        if (numNodes <= 0) throw exception();
-    } catch (exception &e) {
-        std::cout << "Number of nodes should be provided as a positive integer, got '" << argv[1] << "'\n";
-        return EXIT_FAILURE;
+    // Read the edges from all the chunks of the file
+    file.tokenize(numThreads);
+
+    // Report the first invalid line of the file, if any
+    ll line = 1;
+    for (const EdgeChunk &chunk : file.chunks) {
+        checkChunk(chunk, line);
+        line += chunk.numLines;
     }
+}
+
+// Undirected graph of the network stored in the compressed sparse row (CSR) form
+// The neighbors of the node `u` are `adj[offset[u]]` to `adj[offset[u + 1] - 1]` and `weight` holds the
+// weights of those edges. Node numbers, offsets and weights all fit in 32 bits, so every edge takes 8 bytes
+// The three arrays lie one after the other, either in a buffer of the graph or in a snapshot mapped into the memory
+class Graph {
+   public:
+    // The offsets of the adjacency list of every node, followed by the total number of entries
+    uint32_t *offset = nullptr;
 
-    string sourceNode = argv[2];  // The source node
-    string fileName = argv[3];    // The filename containing edges information
+    // The concatenated adjacency lists of all the nodes, and the weights of those edges
+    uint32_t *adj = nullptr, *weight = nullptr;
 
-    // Reading the input edges from the file
-    vector<Edge> edges;
-    readEdges(fileName, edges);
+    // Constructor
+    Graph() = default;
 
-    // Constructing the graph from the edges, and
-    // constructing the map and reverse map from string name to integer name for the nodes
-    map<string, ll> nodeToInt;
-    map<ll, string> intToNode;
-    vector<vector<pair<ll, ll>>> graph;
-    ll sNode = buildGraph(numNodes, edges, nodeToInt, intToNode, sourceNode, graph);
+    // The graph may own a mapping of the memory, so it is never copied
+    Graph(const Graph &) = delete;
+    Graph &operator=(const Graph &) = delete;
 
-    // Executing the dijkstra algorithm
-    vector<ll> distance, parent;
-    dijkstra(numNodes, sNode, distance, parent, graph);
+    // Unmaps the snapshot, if the graph was loaded from one
+    ~Graph() {
+        if (mapped != nullptr) munmap(mapped, mappedSize);
+    }
+
+    // The number of nodes in the graph
+    ll numNodes() const {
+        return n;
+    }
+
+    // The number of entries in the adjacency lists, two for every edge
+    size_t numEntries() const {
+        return offset[n];
+    }
+
+    // Allocates the zeroed arrays of a graph with the given number of nodes and adjacency list entries
+    void allocate(ll numNodes, size_t numEntries) {
+        n = numNodes;
+        storage.assign(numNodes + 1 + 2 * numEntries, 0);
+        setArrays(storage.data(), numEntries);
+    }
+
+    // Uses the arrays starting at `arrays` inside the given mapping of the memory, which the graph then owns
+    void attach(void *addr, size_t size, uint32_t *arrays, ll numNodes, size_t numEntries) {
+        n = numNodes;
+        mapped = addr;
+        mappedSize = size;
+        setArrays(arrays, numEntries);
+    }
+
+   private:
+    // The number of nodes
+    ll n = 0;
+
+    // The arrays of a graph built in the memory
+    vector<uint32_t> storage;
+
+    // The snapshot mapped into the memory, if the graph was loaded from one
+    void *mapped = nullptr;
+    size_t mappedSize = 0;
+
+    // Points the arrays at their positions in the given buffer
+    void setArrays(uint32_t *arrays, size_t numEntries) {
+        offset = arrays;
+        adj = offset + n + 1;
+        weight = adj + numEntries;
+    }
+};
+
+// Builds a graph from the edges read from the input file
+// Interns the string name of each node into the node table, which assigns them normalized
+// integer numbers starting from 0 in the order of their first appearance and keeps the reverse mapping
+// The CSR arrays are filled in two passes, the first one counts the degree of every node
+// and the second one places every edge at its final position
+void buildGraph(ll numNodes, const EdgeFile &file, NodeTable &nodes, Graph &gr) {
+    // Intern the names of every chunk in the order of the chunks, so that every node gets the integer
+    // of its first appearance in the file. `chunkNodes[c][i]` is the integer of the node `i` of the chunk `c`
+    vector<vector<uint32_t>> chunkNodes(file.chunks.size());
+    size_t numEdges = 0;
+    for (size_t c = 0; c < file.chunks.size(); ++c) {
+        for (string_view name : file.chunks[c].nodes.names) {
+            chunkNodes[c].emplace_back(nodes.intern(name));
+        }
+        numEdges += file.chunks[c].size();
+    }
+
+    // The provided input number of nodes and number of distinct nodes found in the
+    // input file should be same
+    if (nodes.size() > numNodes) {
+        std::cout << "Number of distinct nodes in the input file is greater than the given number of nodes\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Every edge is stored in the adjacency list of both of its vertices
+    if (2 * numEdges >= UINT32_MAX) {
+        std::cout << "Number of edges in the input file is too large\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // First pass: loop over all the edges to count the degree of every node
+    gr.allocate(numNodes, 2 * numEdges);
+    for (size_t c = 0; c < file.chunks.size(); ++c) {
+        const vector<uint32_t> &e = file.chunks[c].edges;
+        for (size_t i = 0; i < e.size(); i += 3) {
+            ++gr.offset[chunkNodes[c][e[i]] + 1];
+            ++gr.offset[chunkNodes[c][e[i + 1]] + 1];
+        }
+    }
+
+    // The adjacency list of every node starts where the one of the previous node ends
+    for (ll u = 0; u < numNodes; ++u) {
+        gr.offset[u + 1] += gr.offset[u];
+    }
+
+    // Second pass: push the edge into the adjacency list of both the vertices
+    // keeping the order in which the edges appear in the input file
+    vector<uint32_t> next(gr.offset, gr.offset + numNodes);
+    for (size_t c = 0; c < file.chunks.size(); ++c) {
+        const vector<uint32_t> &e = file.chunks[c].edges;
+        for (size_t i = 0; i < e.size(); i += 3) {
+            uint32_t ui = chunkNodes[c][e[i]], vi = chunkNodes[c][e[i + 1]], w = e[i + 2];
+            gr.adj[next[ui]] = vi;
+            gr.weight[next[ui]++] = w;
+            gr.adj[next[vi]] = ui;
+            gr.weight[next[vi]++] = w;
+        }
+    }
+}
+
+// Identifies the graph snapshot files, and the version of their layout
+#define SNAPSHOT_MAGIC "L4GRAPH"
+#define SNAPSHOT_VERSION 1
+
+// The header of a graph snapshot. It is followed by the three CSR arrays of the graph, the offsets of the names
+// of the nodes (64 bits each, the last one being the total length) and the concatenated names padded to
+// a multiple of 4 bytes, so that the whole file is made of 32-bit words and every array is aligned
+class SnapshotHeader {
+   public:
+    // SNAPSHOT_MAGIC along with its terminating null character, and SNAPSHOT_VERSION
+    char magic[8];
+    uint32_t version, reserved;
+
+    // The number of nodes, of adjacency list entries and of named nodes, and the total length of the names
+    uint64_t numNodes, numEntries, numNames, nameBytes;
+
+    // Checksum of everything after the header
+    uint64_t checksum;
+};
+
+// The number of bytes of the CSR arrays of a snapshot, padded so that the name offsets are 8-byte aligned
+size_t snapshotArrayBytes(uint64_t numNodes, uint64_t numEntries) {
+    return ((numNodes + 1 + 2 * numEntries) * sizeof(uint32_t) + 7) / 8 * 8;
+}
+
+// Checksum of the given number of 32-bit words, continuing from the checksum `h` of the words before them
+// Each word is mixed in like the bytes of the FNV-1a hash
+uint64_t snapshotChecksum(const uint32_t *words, size_t numWords, uint64_t h = 14695981039346656037ULL) {
+    for (size_t i = 0; i < numWords; ++i) {
+        h ^= words[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Whether the given file starts like a graph snapshot
+bool isSnapshot(const string &fileName) {
+    char magic[8] = {};
+    ifstream inFile{fileName, ios::in | ios::binary};
+    inFile.read(magic, sizeof(magic));
+    return inFile && memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+// Writes the snapshot of the graph and the names of its nodes to the given file
+void saveSnapshot(const string &fileName, const Graph &gr, const NodeTable &nodes) {
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.numNodes = gr.numNodes();
+    header.numEntries = gr.numEntries();
+    header.numNames = nodes.size();
+
+    // The arrays of the graph are contiguous, so they are written at once along with their padding
+    size_t arrayWords = gr.numNodes() + 1 + 2 * gr.numEntries();
+    vector<uint32_t> arrayPad(snapshotArrayBytes(header.numNodes, header.numEntries) / sizeof(uint32_t) - arrayWords, 0);
+
+    // The offset of every name and the concatenated names padded to whole words
+    vector<uint64_t> nameOffset{0};
+    for (string_view name : nodes.names) nameOffset.emplace_back(nameOffset.back() + name.size());
+    header.nameBytes = nameOffset.back();
+    vector<uint32_t> names((header.nameBytes + 3) / 4, 0);
+    for (ll i = 0; i < nodes.size(); ++i) {
+        memcpy((char *)names.data() + nameOffset[i], nodes.names[i].data(), nodes.names[i].size());
+    }
+
+    header.checksum = snapshotChecksum(gr.offset, arrayWords);
+    header.checksum = snapshotChecksum(arrayPad.data(), arrayPad.size(), header.checksum);
+    header.checksum = snapshotChecksum((const uint32_t *)nameOffset.data(), 2 * nameOffset.size(), header.checksum);
+    header.checksum = snapshotChecksum(names.data(), names.size(), header.checksum);
+
+    ofstream outFile{fileName, ios::out | ios::binary};
+    outFile.write((const char *)&header, sizeof(header));
+    outFile.write((const char *)gr.offset, arrayWords * sizeof(uint32_t));
+    outFile.write((const char *)arrayPad.data(), arrayPad.size() * sizeof(uint32_t));
+    outFile.write((const char *)nameOffset.data(), nameOffset.size() * sizeof(uint64_t));
+    outFile.write((const char *)names.data(), names.size() * sizeof(uint32_t));
+    outFile.close();
+
+    // If the file could not be written, exit with failure status
+    if (!outFile) {
+        std::cout << "Snapshot '" << fileName << "' could not be written!\n";
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Maps the graph snapshot of the given file into the memory and uses its arrays as the graph
+// The names of the nodes are interned as views into the mapping, so the graph must outlive the node table
+// The checksum and the structure of the graph are verified only if asked to, as that reads the whole file
+void loadSnapshot(const string &fileName, bool verify, Graph &gr, NodeTable &nodes) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) != 0) {
+        std::cout << "File '" << fileName << "' could not be opened!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // A private writable mapping, so that the weights can be updated without touching the file
+    size_t size = st.st_size;
+    void *addr = size < sizeof(SnapshotHeader) ? MAP_FAILED : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cout << "Snapshot '" << fileName << "' could not be mapped into the memory\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // The sizes in the header should add up to the size of the file
+    const SnapshotHeader &header = *(const SnapshotHeader *)addr;
+    size_t arrayBytes = snapshotArrayBytes(header.numNodes, header.numEntries);
+    size_t nameOffsetBytes = (header.numNames + 1) * sizeof(uint64_t);
+    size_t nameWordBytes = (header.nameBytes + 3) / 4 * 4;
+    if (header.version != SNAPSHOT_VERSION || header.numNodes >= UINT32_MAX || header.numEntries >= UINT32_MAX ||
+        header.numNames > header.numNodes || header.nameBytes > size ||
+        sizeof(SnapshotHeader) + arrayBytes + nameOffsetBytes + nameWordBytes != size) {
+        std::cout << "Snapshot '" << fileName << "' has an unsupported version or is corrupted\n";
+        exit(EXIT_FAILURE);
+    }
+
+    char *body = (char *)addr + sizeof(SnapshotHeader);
+    uint32_t *arrays = (uint32_t *)body;
+    const uint64_t *nameOffset = (const uint64_t *)(body + arrayBytes);
+    const char *names = body + arrayBytes + nameOffsetBytes;
+    gr.attach(addr, size, arrays, header.numNodes, header.numEntries);
+
+    if (verify) {
+        bool valid = snapshotChecksum(arrays, (size - sizeof(SnapshotHeader)) / 4) == header.checksum;
+        valid = valid && gr.offset[0] == 0 && gr.offset[gr.numNodes()] == header.numEntries;
+        for (ll u = 0; valid && u < gr.numNodes(); ++u) {
+            valid = gr.offset[u] <= gr.offset[u + 1];
+        }
+        for (size_t j = 0; valid && j < header.numEntries; ++j) {
+            valid = gr.adj[j] < gr.numNodes() && gr.weight[j] > 0 && gr.weight[j] < MAX_EDGE_WEIGHT;
+        }
+        if (!valid || nameOffset[header.numNames] != header.nameBytes) {
+            std::cout << "Snapshot '" << fileName << "' failed the verification\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Every name should get the integer of its position in the snapshot
+    nodes.reserve(header.numNames);
+    for (uint64_t i = 0; i < header.numNames; ++i) {
+        if (nameOffset[i] > nameOffset[i + 1] || nameOffset[i + 1] > header.nameBytes ||
+            nodes.internView(string_view(names + nameOffset[i], nameOffset[i + 1] - nameOffset[i])) != (ll)i) {
+            std::cout << "Snapshot '" << fileName << "' has an invalid table of the node names\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Number of bytes of the input file read at once by the semi-external build
+// The adjacency list entries of every block are sorted in the memory into one run of the external sort
+#define EXTERNAL_BLOCK_SIZE (32 << 20)
+
+// Number of bytes buffered by every writer of the semi-external build before writing them to the file
+#define EXTERNAL_BUFFER_SIZE (1 << 20)
+
+// An entry of the adjacency lists in the runs of the semi-external build, the edge from `u` to `v`
+class ExternalEntry {
+   public:
+    uint32_t u, v, w;
+};
+
+// Sorts the entries by their node keeping the order of the entries of the same node, with a radix sort
+// over the lower and then the upper 16 bits of the node, using `tmp` as the buffer of the first pass
+void radixSortEntries(vector<ExternalEntry> &entries, vector<ExternalEntry> &tmp) {
+    tmp.resize(entries.size());
+    for (int shift : {0, 16}) {
+        vector<size_t> count((1 << 16) + 1, 0);
+        for (const ExternalEntry &e : entries) ++count[((e.u >> shift) & 0xffff) + 1];
+        for (size_t k = 1; k < count.size(); ++k) count[k] += count[k - 1];
+        for (const ExternalEntry &e : entries) tmp[count[(e.u >> shift) & 0xffff]++] = e;
+        entries.swap(tmp);
+    }
+}
+
+// Creates a new file named after the given file with a random suffix, and returns its name and descriptor
+int createTemporary(const string &fileName, string &name) {
+    name = fileName + ".XXXXXX";
+    int fd = mkstemp(name.data());
+    if (fd == -1) {
+        std::cout << "Could not create a temporary file next to '" << fileName << "'\n";
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+// Writes the given bytes to the file at the given position, exits with failure status if they could not be written
+void writeAt(int fd, const void *data, size_t bytes, size_t pos, const string &fileName) {
+    for (size_t done = 0; done < bytes;) {
+        ssize_t n = pwrite(fd, (const char *)data + done, bytes - done, pos + done);
+        if (n <= 0) {
+            std::cout << "File '" << fileName << "' could not be written!\n";
+            exit(EXIT_FAILURE);
+        }
+        done += n;
+    }
+}
+
+// Writes 32-bit words one after the other to a file from the given position, buffering them
+class WordWriter {
+   public:
+    // Constructor
+    WordWriter(int fd, size_t pos, const string &fileName) : fd{fd}, pos{pos}, fileName{fileName} {
+        buffer.reserve(EXTERNAL_BUFFER_SIZE / sizeof(uint32_t));
+    }
+
+    // Writes the remaining buffered words
+    ~WordWriter() {
+        flush();
+    }
+
+    // Appends the word
+    void write(uint32_t word) {
+        buffer.emplace_back(word);
+        if (buffer.size() == buffer.capacity()) flush();
+    }
+
+   private:
+    // The file, the position of the next word to write and the name of the file for the errors
+    int fd;
+    size_t pos;
+    const string &fileName;
+
+    // The words not written yet
+    vector<uint32_t> buffer;
+
+    // Writes the buffered words to the file
+    void flush() {
+        writeAt(fd, buffer.data(), buffer.size() * sizeof(uint32_t), pos, fileName);
+        pos += buffer.size() * sizeof(uint32_t);
+        buffer.clear();
+    }
+};
+
+// Builds the snapshot of the graph of the given text file of edges with an external sort, keeping only
+// the names, the offsets of the adjacency lists and one block of the edges in the memory
+// Every block of the file is tokenized and its adjacency list entries, sorted by their node keeping the order
+// of the file, are appended as a run to a temporary file. All the runs are then merged into the adjacency
+// arrays of the snapshot, each of them being read sequentially, so the graph comes out exactly as `buildGraph`
+// builds it. The snapshot is written to the given file, or to a temporary file next to the input file if none
+// is given. Returns the name of the snapshot. Reading the edges and merging the runs end a phase of the timer each
+string externalBuild(ll numNodes, const string &fileName, const string &saveFile, PhaseTimer &timer) {
+    EdgeFile file;
+    if (!file.open(fileName)) {
+        std::cout << "File '" << fileName << "' could not be opened!\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // The runs are kept in a temporary file next to the input file, removed as soon as it is created
+    string runsFile;
+    int runsFd = createTemporary(fileName, runsFile);
+    unlink(runsFile.c_str());
+
+    // The edges of the current block with the table of the names of all the blocks, which assigns the integers
+    // in the order of the first appearance in the file. The degree of every node, shifted by one so that
+    // it becomes the offset of the next node, and the position of every run in the file of runs followed
+    // by their end, in number of entries
+    EdgeChunk chunk;
+    chunk.nodes = NodeTable(true);
+    const NodeTable &nodes = chunk.nodes;
+    vector<uint32_t> offset(numNodes + 1, 0);
+    vector<size_t> runStart{0};
+
+    ll line = 1;
+    vector<ExternalEntry> entries, tmp;
+    file.tokenizeBlocks(EXTERNAL_BLOCK_SIZE, chunk, [&](const EdgeChunk &chunk) {
+        checkChunk(chunk, line);
+        line += chunk.numLines;
+        if (nodes.size() > numNodes) {
+            std::cout << "Number of distinct nodes in the input file is greater than the given number of nodes\n";
+            exit(EXIT_FAILURE);
+        }
+
+        // Every edge is an entry in the adjacency lists of both of its vertices
+        entries.clear();
+        for (size_t i = 0; i < chunk.edges.size(); i += 3) {
+            uint32_t ui = chunk.edges[i], vi = chunk.edges[i + 1], w = chunk.edges[i + 2];
+            entries.push_back({ui, vi, w});
+            entries.push_back({vi, ui, w});
+            ++offset[ui + 1];
+            ++offset[vi + 1];
+        }
+        radixSortEntries(entries, tmp);
+
+        writeAt(runsFd, entries.data(), entries.size() * sizeof(ExternalEntry), runStart.back() * sizeof(ExternalEntry), runsFile);
+        runStart.emplace_back(runStart.back() + entries.size());
+    });
+    vector<ExternalEntry>().swap(entries);
+    vector<ExternalEntry>().swap(tmp);
+    timer.lap("parse");
+
+    size_t numEntries = runStart.back();
+    if (numEntries >= UINT32_MAX) {
+        std::cout << "Number of edges in the input file is too large\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // The adjacency list of every node starts where the one of the previous node ends
+    for (ll u = 0; u < numNodes; ++u) offset[u + 1] += offset[u];
+
+    // The layout of the snapshot, the padding being left as zeros by sizing the file first
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.numNodes = numNodes;
+    header.numEntries = numEntries;
+    header.numNames = nodes.size();
+    vector<uint64_t> nameOffset{0};
+    for (string_view name : nodes.names) nameOffset.emplace_back(nameOffset.back() + name.size());
+    header.nameBytes = nameOffset.back();
+
+    size_t arrayPos = sizeof(SnapshotHeader), namePos = arrayPos + snapshotArrayBytes(numNodes, numEntries);
+    size_t size = namePos + nameOffset.size() * sizeof(uint64_t) + (header.nameBytes + 3) / 4 * 4;
+    string snapshotFile = saveFile;
+    int fd = saveFile.empty() ? createTemporary(fileName, snapshotFile) : open(saveFile.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1 || ftruncate(fd, size) != 0) {
+        std::cout << "Snapshot '" << snapshotFile << "' could not be written!\n";
+        exit(EXIT_FAILURE);
+    }
+    writeAt(fd, offset.data(), offset.size() * sizeof(uint32_t), arrayPos, snapshotFile);
+    writeAt(fd, nameOffset.data(), nameOffset.size() * sizeof(uint64_t), namePos, snapshotFile);
+    size_t pos = namePos + nameOffset.size() * sizeof(uint64_t);
+    for (string_view name : nodes.names) {
+        writeAt(fd, name.data(), name.size(), pos, snapshotFile);
+        pos += name.size();
+    }
+
+    // Merge the runs, taking the run with the smallest node next and the earliest run among the equal nodes
+    // All the entries of that node in the run are taken at once, as they are next to each other
+    if (numEntries != 0) {
+        void *addr = mmap(nullptr, numEntries * sizeof(ExternalEntry), PROT_READ, MAP_PRIVATE, runsFd, 0);
+        if (addr == MAP_FAILED) {
+            std::cout << "File '" << runsFile << "' could not be mapped into the memory\n";
+            exit(EXIT_FAILURE);
+        }
+        madvise(addr, numEntries * sizeof(ExternalEntry), MADV_SEQUENTIAL);
+        const ExternalEntry *runs = (const ExternalEntry *)addr;
+
+        {
+            WordWriter adj(fd, arrayPos + (numNodes + 1) * sizeof(uint32_t), snapshotFile);
+            WordWriter weight(fd, arrayPos + (numNodes + 1 + numEntries) * sizeof(uint32_t), snapshotFile);
+            vector<size_t> next(runStart.begin(), runStart.end() - 1);
+            priority_queue<pair<uint32_t, size_t>, vector<pair<uint32_t, size_t>>, greater<pair<uint32_t, size_t>>> pq;
+            for (size_t r = 0; r < next.size(); ++r) {
+                if (next[r] < runStart[r + 1]) pq.emplace(runs[next[r]].u, r);
+            }
+            while (!pq.empty()) {
+                auto [u, r] = pq.top();
+                pq.pop();
+                for (; next[r] < runStart[r + 1] && runs[next[r]].u == u; ++next[r]) {
+                    adj.write(runs[next[r]].v);
+                    weight.write(runs[next[r]].w);
+                }
+                if (next[r] < runStart[r + 1]) pq.emplace(runs[next[r]].u, r);
+            }
+        }
+        munmap(addr, numEntries * sizeof(ExternalEntry));
+    }
+    close(runsFd);
+
+    // The checksum of everything after the header, reading the snapshot back sequentially
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        std::cout << "Snapshot '" << snapshotFile << "' could not be mapped into the memory\n";
+        exit(EXIT_FAILURE);
+    }
+    madvise(addr, size, MADV_SEQUENTIAL);
+    header.checksum = snapshotChecksum((const uint32_t *)((const char *)addr + arrayPos), (size - arrayPos) / sizeof(uint32_t));
+    munmap(addr, size);
+    writeAt(fd, &header, sizeof(header), 0, snapshotFile);
+    close(fd);
+    timer.lap("build");
+    return snapshotFile;
+}
+
+// Builds the graph from the given file, which is either a text file of edges or a graph snapshot
+// Also saves the snapshot of the graph, if asked to. Every step ends a phase of the timer
+void loadGraph(ll numNodes, const string &fileName, const Options &opts, NodeTable &nodes, Graph &gr, PhaseTimer &timer) {
+    if (isSnapshot(fileName)) {
+        loadSnapshot(fileName, opts.verifySnapshot, gr, nodes);
+        timer.lap("load");
+
+        // The rows of the routing tables depend on the number of nodes, so it should be the one of the snapshot
+        if (gr.numNodes() != numNodes) {
+            std::cout << "Snapshot '" << fileName << "' has " << gr.numNodes() << " nodes, but " << numNodes << " were given\n";
+            exit(EXIT_FAILURE);
+        }
+    } else if (opts.semiExternal) {
+        // Building the snapshot on the disk and mapping it, the snapshot being saved where asked to
+        // or in a temporary file, which is removed once it is mapped
+        string snapshotFile = externalBuild(numNodes, fileName, opts.saveSnapshot, timer);
+        loadSnapshot(snapshotFile, opts.verifySnapshot, gr, nodes);
+        if (opts.saveSnapshot.empty()) unlink(snapshotFile.c_str());
+        timer.lap("load");
+
+        // The snapshot is already saved
+        return;
+    } else {
+        // Reading the input edges from the file
+        EdgeFile edges;
+        readEdges(fileName, opts.threads, edges);
+        timer.lap("parse");
+
+        // Constructing the graph from the edges, and
+        // constructing the table of integer names for the string names of the nodes
+        buildGraph(numNodes, edges, nodes, gr);
+        timer.lap("build");
+    }
+
+    if (!opts.saveSnapshot.empty()) {
+        saveSnapshot(opts.saveSnapshot, gr, nodes);
+        timer.lap("save-snapshot");
+    }
+}
+
+// Indexed d-ary min-heap of the nodes keyed by their tentative distance from the source node
+// Ties are broken by the smaller node number, so nodes leave the heap in the same order
+// in which the linear scan would have picked them
+class IndexedHeap {
+   public:
+    // Constructor
+    IndexedHeap(ll arity = DEFAULT_HEAP_ARITY) : arity{max(arity, 2LL)} {}
+
+    // Empties the heap so that it can hold the nodes `0` to `numNodes - 1`
+    // Only the nodes left in the heap are touched when it already holds that many nodes
+    void reset(ll numNodes) {
+        if ((ll)pos.size() == numNodes) {
+            for (auto &e : heap) pos[e.second] = -1;
+        } else {
+            pos.assign(numNodes, -1);
+        }
+        heap.clear();
+    }
+
+    // Whether the heap is empty or not
+    bool empty() const {
+        return heap.empty();
+    }
+
+    // Inserts the node `v` with the given key, or decreases its key if it is already in the heap
+    void push(ll v, ll key) {
+        ll i = pos[v];
+        if (i == -1) {
+            // Insert the node at the end of the heap
+            i = heap.size();
+            heap.emplace_back(key, v);
+        } else {
+            heap[i].first = key;
+        }
+        siftUp(i);
+    }
+
+    // Returns the (key, node) pair with the minimum key in the heap
+    const pair<ll, ll> &top() const {
+        return heap[0];
+    }
+
+    // Removes and returns the (key, node) pair with the minimum key from the heap
+    pair<ll, ll> pop() {
+        pair<ll, ll> top = heap[0];
+        pos[top.second] = -1;
+
+        // Move the last element to the root and restore the heap property
+        pair<ll, ll> last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            pos[last.second] = 0;
+            siftDown(0);
+        }
+        return top;
+    }
+
+   private:
+    // The number of children of every node of the heap
+    ll arity;
+
+    // The heap of (key, node) pairs, and the position of every node in the heap (-1 if not present)
+    vector<pair<ll, ll>> heap;
+    vector<ll> pos;
+
+    // Moves the element at index `i` up till its parent is smaller than it
+    void siftUp(ll i) {
+        pair<ll, ll> e = heap[i];
+        while (i > 0) {
+            ll p = (i - 1) / arity;
+            if (!(e < heap[p])) break;
+            heap[i] = heap[p];
+            pos[heap[i].second] = i;
+            i = p;
+        }
+        heap[i] = e;
+        pos[e.second] = i;
+    }
+
+    // Moves the element at index `i` down till all its children are larger than it
+    void siftDown(ll i) {
+        pair<ll, ll> e = heap[i];
+        ll n = heap.size();
+        while (true) {
+            // Find the smallest child of the current position
+            ll first = i * arity + 1;
+            if (first >= n) break;
+            ll last = min(first + arity, n), c = first;
+            for (ll j = first + 1; j < last; ++j) {
+                if (heap[j] < heap[c]) c = j;
+            }
+            if (!(heap[c] < e)) break;
+            heap[i] = heap[c];
+            pos[heap[i].second] = i;
+            i = c;
+        }
+        heap[i] = e;
+        pos[e.second] = i;
+    }
+};
+
+// Dial's bucket queue of the nodes keyed by their tentative distance from the source node
+// As every edge weight is less than MAX_EDGE_WEIGHT, all the keys present in the queue lie in a window
+// of MAX_EDGE_WEIGHT consecutive values, so a circular array of that many buckets is enough.
+// Stale entries are not removed on a decrease-key, the caller skips them when they are popped.
+class BucketQueue {
+   public:
+    // Constructor, the buckets are only allocated by the first run using the queue
+    BucketQueue() : curr{0}, count{0} {}
+
+    // Empties the queue, the number of nodes is only taken to match IndexedHeap::reset
+    void reset(ll /*numNodes*/) {
+        if (buckets.empty()) {
+            buckets.resize((ll)MAX_EDGE_WEIGHT);
+        } else if (count != 0) {
+            for (auto &b : buckets) b.clear();
+        }
+        curr = count = 0;
+    }
+
+    // Whether the queue is empty or not
+    bool empty() const {
+        return count == 0;
+    }
+
+    // Inserts the node `v` with the given key
+    void push(ll v, ll key) {
+        buckets[key % buckets.size()].emplace_back(v);
+        ++count;
+    }
+
+    // Removes and returns the (key, node) pair with the minimum key from the queue
+    pair<ll, ll> pop() {
+        vector<ll> *b = &buckets[curr % buckets.size()];
+        if (b->empty()) {
+            // Advance to the next non-empty bucket. No new node can enter a bucket once it is
+            // reached as the weights are positive, so sort it in decreasing order of the nodes
+            // to pop the nodes having the same key in increasing order, like the linear scan
+            do {
+                ++curr;
+                b = &buckets[curr % buckets.size()];
+            } while (b->empty());
+            sort(b->begin(), b->end(), greater<ll>());
+        }
+        ll v = b->back();
+        b->pop_back();
+        --count;
+        return make_pair(curr, v);
+    }
+
+   private:
+    // The circular array of buckets, where bucket `k % size` holds the nodes with key `k`
+    vector<vector<ll>> buckets;
+
+    // The key of the current bucket and the number of entries in the queue
+    ll curr, count;
+};
+
+// Counters of the work done by the shortest path kernels, summed over all their runs
+// Every kernel counts in local variables and adds them here once at the end of its run
+class SpfCounters {
+   public:
+    // The edges examined, the edges which decreased the distance of their end, and the entries pushed into
+    // and taken out of the priority queue (the nodes picked by the linear scan, the frontier of the delta-stepping)
+    ll relaxations = 0, decreases = 0, pushes = 0, pops = 0;
+
+    // Adds the given counters to these counters
+    SpfCounters &operator+=(const SpfCounters &other) {
+        relaxations += other.relaxations;
+        decreases += other.decreases;
+        pushes += other.pushes;
+        pops += other.pops;
+        return *this;
+    }
+};
+
+// Scratch buffers of the Dijkstra algorithm, every thread keeps its own to reuse them across the runs
+class SpfScratch {
+   public:
+    // The distance and the parent of every node in its shortest path from the source node
+    vector<ll> distance, parent;
+
+    // Keep track of which nodes have been visited so far
+    vector<bool> visited;
+
+    // The equal-cost predecessors of every node in the shortest path DAG, only filled by `equalCostDag`
+    // The predecessors of the node `v` are `preds[predOffset[v]]` to `preds[predOffset[v + 1] - 1]`
+    vector<uint32_t> predOffset, preds;
+
+    // The priority queues that can be used to pick the next closest node
+    IndexedHeap heap;
+    BucketQueue buckets;
+
+    // The work done by all the runs using these buffers
+    SpfCounters counters;
+
+    // Constructor
+    SpfScratch(ll arity = DEFAULT_HEAP_ARITY) : heap(arity) {}
+
+    // Prepares the buffers for a run over `numNodes` nodes from the source node
+    void reset(ll numNodes, ll sourceNode) {
+        // Initially all the nodes are not visited
+        visited.assign(numNodes, false);
+
+        // Initialize the distance of all the nodes from the source node as INFINITY
+        distance.assign(numNodes, INF);
+        // Initialize the parent of all the nodes as -1 in their shortest path from the source node
+        parent.assign(numNodes, -1);
+
+        distance[sourceNode] = 0;  // Distance of the source node from itself is zero
+    }
+};
+
+// Performs the Dijkstra algorithm using the given priority queue to pick the next closest node
+// fills the distance and the parent vectors of the scratch buffers from the source node
+template <typename Queue>
+void queueDijkstra(Queue &pq, ll sourceNode, const Graph &gr, SpfScratch &s) {
+    s.reset(gr.numNodes(), sourceNode);
+    vector<ll> &distance = s.distance, &parent = s.parent;
+    vector<bool> &visited = s.visited;
+
+    pq.reset(gr.numNodes());
+    pq.push(sourceNode, 0);
+    SpfCounters c;
+    c.pushes = 1;
+
+    while (!pq.empty()) {
+        // Take the unvisited node having the minimum distance
+        auto [d, u] = pq.pop();
+        ++c.pops;
+
+        // Skip the stale entries left behind by the queues without decrease-key
+        if (visited[u] || d != distance[u]) continue;
+
+        visited[u] = true;  // Mark this node as visited
+
+        // Iterate over all the edges of the current node
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            // The neighbor node and the edge weight
+            ll v = gr.adj[j], w = gr.weight[j];
+            ++c.relaxations;
+            // Relax the edge exactly like the linear scan does, so that the ties are resolved in the same way
+            if (distance[u] + w < distance[v]) {
+                distance[v] = distance[u] + w;
+                parent[v] = u;
+                pq.push(v, distance[v]);
+                ++c.decreases;
+                ++c.pushes;
+            }
+        }
+    }
+    s.counters += c;
+}
+
+// Performs the Dijkstra algorithm on the given graph from the source node by linearly scanning
+// the unvisited nodes, fills the distance and the parent vectors of the scratch buffers from the source node
+void linearDijkstra(ll sourceNode, const Graph &gr, SpfScratch &s) {
+    ll numNodes = gr.numNodes();
+    s.reset(numNodes, sourceNode);
+    vector<ll> &distance = s.distance, &parent = s.parent;
+    vector<bool> &visited = s.visited;
+    SpfCounters c;
+
+    // Iterate over all the nodes
+    for (ll i = 0; i < numNodes; ++i) {
+        // Find the node having the minimum distance among all the unvisited nodes
+        int u = -1;
+        for (int j = 0; j < numNodes; ++j) {
+            if (!visited[j] && (u == -1 || distance[j] < distance[u])) {
+                u = j;
+            }
+        }
+
+        // It means that all the remaining unvisited nodes are unreachable from the source node
+        if (distance[u] == INF) break;
+
+        visited[u] = true;  // Mark this node as visited
+        ++c.pops;
+
+        // Iterate over all the edges of the current node
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            // The neighbor node and the edge weight
+            ll v = gr.adj[j], w = gr.weight[j];
+            ++c.relaxations;
+            // If the neighbor node can be reached from the source node in less distance
+            // when using the current node, then update the distance of the neighbor node
+            // and marks its parent as the current node on the least cost path
+            if (distance[u] + w < distance[v]) {
+                distance[v] = distance[u] + w;
+                parent[v] = u;
+                ++c.decreases;
+            }
+        }
+    }
+    s.counters += c;
+}
+
+// Barrier at which a fixed number of threads wait for each other before moving to the next phase
+class Barrier {
+   public:
+    // Constructor
+    Barrier(ll numThreads) : numThreads{numThreads}, waiting{0}, generation{0} {}
+
+    // Blocks till all the threads have arrived at the barrier
+    void wait() {
+        unique_lock<mutex> lock(m);
+        ll gen = generation;
+        if (++waiting == numThreads) {
+            // The last thread to arrive releases all the others
+            waiting = 0;
+            ++generation;
+            cv.notify_all();
+        } else {
+            cv.wait(lock, [&] { return gen != generation; });
+        }
+    }
+
+   private:
+    mutex m;
+    condition_variable cv;
+
+    // The number of threads, the number of them waiting and the number of times the barrier was passed
+    ll numThreads, waiting, generation;
+};
+
+// Lowers the distance to the given value if that is smaller, atomically with respect to the other threads
+// Returns whether the distance was lowered
+bool atomicMin(ll &distance, ll value) {
+    ll old = __atomic_load_n(&distance, __ATOMIC_RELAXED);
+    while (value < old) {
+        if (__atomic_compare_exchange_n(&distance, &old, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) return true;
+    }
+    return false;
+}
+
+// Performs the delta-stepping algorithm on the given graph from the source node with all the threads
+// fills the distance and the parent vectors of the scratch buffers from the source node
+// The nodes are kept in buckets of width delta by their tentative distance. The smallest bucket is settled
+// in phases where the threads relax the light edges (weight at most delta) of its nodes in parallel, as those
+// may put nodes back into the same bucket. Once the bucket stays empty the heavy edges of all its nodes are relaxed
+// at once. The distances are lowered with atomic min operations, so every thread keeps its own buckets, which
+// are gathered into the shared frontier between the phases. A relaxation lands at most the largest edge weight past
+// the bucket being settled, so like a Dial queue the buckets are a cyclic array of ceil(maxWeight / delta) + 1 slots,
+// the bucket `b` being kept in the slot `b % numSlots`. The parents are then set by the rule of the Dijkstra
+// algorithm, the tight neighbor with the smallest (distance, integer name), giving exactly its shortest path tree
+void deltaStepping(ll sourceNode, const Graph &gr, const Options &opts, SpfScratch &s) {
+    ll numNodes = gr.numNodes(), numThreads = opts.threads;
+    s.reset(numNodes, sourceNode);
+    vector<ll> &distance = s.distance, &parent = s.parent;
+
+    // The width of the buckets, the mean edge weight unless given, and the number of slots of the cyclic buckets
+    ll delta = opts.delta, total = 0, maxWeight = 0;
+    for (size_t j = 0; j < gr.numEntries(); ++j) {
+        total += gr.weight[j];
+        maxWeight = max(maxWeight, (ll)gr.weight[j]);
+    }
+    if (delta == 0) delta = max(1LL, total / max((ll)gr.numEntries(), 1LL));
+    ll numSlots = (maxWeight + delta - 1) / delta + 1;
+
+    // The nodes of the bucket being settled and the position of the next block of them to take
+    vector<uint32_t> frontier{(uint32_t)sourceNode};
+    atomic<size_t> nextBlock{0};
+
+    // The bucket being settled and the next one, and whether the heavy edges of the settled nodes are to be
+    // relaxed or all the buckets are empty. These are only changed by the thread 0 between the barriers
+    ll currBucket = 0, nextBucket = 0;
+    bool heavyPhase = false, done = false;
+
+    // The buckets of every thread, the nodes it settled in the current bucket, its smallest non-empty bucket
+    // and the position of its part of the frontier
+    vector<vector<vector<uint32_t>>> buckets(numThreads, vector<vector<uint32_t>>(numSlots));
+    vector<vector<uint32_t>> settled(numThreads);
+    vector<ll> minBucket(numThreads);
+    vector<size_t> frontierPos(numThreads + 1);
+    Barrier barrier(numThreads);
+
+    // The work done by every thread, a push being an insertion into a bucket
+    vector<SpfCounters> counters(numThreads);
+
+    auto work = [&](ll t) {
+        vector<vector<uint32_t>> &myBuckets = buckets[t];
+        SpfCounters c;
+
+        // Relaxes either the light or the heavy edges of the node at the given distance
+        auto relax = [&](ll u, ll du, bool light) {
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                ll w = gr.weight[j];
+                if ((w <= delta) != light) continue;
+                ll v = gr.adj[j], d = du + w;
+                ++c.relaxations;
+                if (!atomicMin(distance[v], d)) continue;
+                ++c.decreases;
+                ++c.pushes;
+                myBuckets[d / delta % numSlots].emplace_back(v);
+            }
+        };
+
+        while (true) {
+            // Relax the light edges of the frontier, skipping the nodes which moved to a smaller bucket
+            for (size_t i; (i = nextBlock.fetch_add(DELTA_BLOCK_SIZE)) < frontier.size();) {
+                for (size_t k = i; k < min(i + DELTA_BLOCK_SIZE, frontier.size()); ++k) {
+                    ll u = frontier[k], du = __atomic_load_n(&distance[u], __ATOMIC_RELAXED);
+                    if (du / delta != currBucket) continue;
+                    ++c.pops;
+                    settled[t].emplace_back(u);
+                    relax(u, du, true);
+                }
+            }
+            barrier.wait();
+
+            // Find the next non-empty bucket, relaxing the heavy edges once the current bucket stays empty
+            while (true) {
+                ll b = currBucket;
+                while (b < currBucket + numSlots && myBuckets[b % numSlots].empty()) ++b;
+                minBucket[t] = b < currBucket + numSlots ? b : LLONG_MAX;
+                barrier.wait();
+                if (t == 0) {
+                    nextBucket = *min_element(minBucket.begin(), minBucket.end());
+                    bool anySettled = any_of(settled.begin(), settled.end(), [](const vector<uint32_t> &v) { return !v.empty(); });
+                    heavyPhase = nextBucket != currBucket && anySettled;
+                    done = nextBucket == LLONG_MAX && !heavyPhase;
+                }
+                barrier.wait();
+                if (!heavyPhase) break;
+                for (ll u : settled[t]) relax(u, distance[u], false);
+                settled[t].clear();
+                barrier.wait();
+            }
+            if (done) break;
+
+            // Gather the next bucket of all the threads into the frontier
+            frontierPos[t + 1] = myBuckets[nextBucket % numSlots].size();
+            barrier.wait();
+            if (t == 0) {
+                for (ll i = 0; i < numThreads; ++i) frontierPos[i + 1] += frontierPos[i];
+                frontier.resize(frontierPos[numThreads]);
+                currBucket = nextBucket;
+                nextBlock = 0;
+            }
+            barrier.wait();
+            vector<uint32_t> &bucket = myBuckets[currBucket % numSlots];
+            copy(bucket.begin(), bucket.end(), frontier.begin() + frontierPos[t]);
+            vector<uint32_t>().swap(bucket);
+            barrier.wait();
+        }
+
+        // Set the parent of every node in the range of the thread by the rule of the Dijkstra algorithm
+        for (ll x = numNodes * t / numThreads; x < numNodes * (t + 1) / numThreads; ++x) {
+            if (x == sourceNode || distance[x] == INF) continue;
+            for (uint32_t j = gr.offset[x]; j < gr.offset[x + 1]; ++j) {
+                ll y = gr.adj[j], p = parent[x];
+                if (distance[y] + gr.weight[j] != distance[x]) continue;
+                if (p == -1 || make_pair(distance[y], y) < make_pair(distance[p], p)) parent[x] = y;
+            }
+        }
+        counters[t] = c;
+    };
+
+    vector<thread> pool;
+    for (ll t = 1; t < numThreads; ++t) pool.emplace_back(work, t);
+    work(0);
+    for (thread &th : pool) th.join();
+    for (const SpfCounters &c : counters) s.counters += c;
+
+    // Every node reached from the source node is visited
+    for (ll x = 0; x < numNodes; ++x) s.visited[x] = distance[x] != INF;
+}
+
+// Performs the Dijkstra algorithm on the given graph from the source node using the chosen priority queue
+// fills the distance and the parent vectors of the scratch buffers from the source node
+// The delta-stepping kernel takes over when chosen, unless the graph is too small for the threads to pay off
+void dijkstra(ll sourceNode, const Graph &gr, const Options &opts, SpfScratch &scratch) {
+    if (opts.kernel == SpfKernel::DELTA && gr.numEntries() >= DELTA_MIN_ENTRIES) {
+        deltaStepping(sourceNode, gr, opts, scratch);
+    } else if (opts.queue == QueueType::HEAP) {
+        queueDijkstra(scratch.heap, sourceNode, gr, scratch);
+    } else if (opts.queue == QueueType::DIAL) {
+        queueDijkstra(scratch.buckets, sourceNode, gr, scratch);
+    } else {
+        linearDijkstra(sourceNode, gr, scratch);
+    }
+}
+
+// Number of bytes of the output buffered before writing them to the stream
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+// Buffers the output written to a stream, formatting the numbers and padding the columns in place
+// without going through the formatting state of the stream, which is costly for the large tables
+class OutputBuffer {
+   public:
+    // Constructor
+    OutputBuffer(ostream &os) : os{os} {
+        buffer.reserve(OUTPUT_BUFFER_SIZE);
+    }
+
+    // Writes the remaining buffered output
+    ~OutputBuffer() {
+        flush();
+    }
+
+    // Appends the text
+    void put(string_view text) {
+        append(text);
+        flushIfFull();
+    }
+
+    // Appends the number
+    void put(ll x) {
+        append(x);
+        flushIfFull();
+    }
+
+    // Appends the text or the number left aligned in a column of the given width, filled with spaces
+    // The column is complete before the buffer may be flushed, so the padding always follows its value
+    template <typename T>
+    void pad(const T &value, size_t width) {
+        size_t start = buffer.size();
+        append(value);
+        if (buffer.size() - start < width) buffer.append(width - (buffer.size() - start), ' ');
+        flushIfFull();
+    }
+
+    // Appends the raw bytes
+    void write(const void *data, size_t bytes) {
+        put(string_view((const char *)data, bytes));
+    }
+
+    // Appends `n` bytes to be filled by the caller and returns where they start
+    char *extend(size_t n) {
+        if (buffer.size() + n >= OUTPUT_BUFFER_SIZE) flush();
+        buffer.resize(buffer.size() + n);
+        return buffer.data() + buffer.size() - n;
+    }
+
+    // Writes the buffered output to the stream
+    void flush() {
+        os.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+   private:
+    // The stream and the output not written to it yet
+    ostream &os;
+    string buffer;
+
+    // Appends the text without flushing
+    void append(string_view text) {
+        buffer.append(text);
+    }
+
+    // Appends the number without flushing
+    void append(ll x) {
+        char digits[24];
+        buffer.append(digits, to_chars(digits, digits + sizeof(digits), x).ptr - digits);
+    }
+
+    // Writes the buffered output once it is large enough
+    void flushIfFull() {
+        if (buffer.size() >= OUTPUT_BUFFER_SIZE) flush();
+    }
+};
+
+// Generic function to pretty print any input with defined width, alignment and fill character
+template <typename T>
+void prettyPrint(ostream &os, const T &res, ll width, std::ios_base &(*positioning)(std::ios_base &) = std::left, char fillChar = ' ') {
+    ios init(NULL);
+    // copying the default formatting of the stream
+    init.copyfmt(os);
+    // pretty printing the input
+    os << setfill(fillChar) << setw(width) << positioning << res;
+    // resetting the default formatting of the stream
+    os.copyfmt(init);
+}
+
+// Pretty prints the row of the node `i` in the results of the Dijkstra algorithm to the given output
+// The row has the least cost path from the source node to the node along with the path price
+void printRow(ll i, const vector<ll> &distance, const vector<ll> &parent, const NodeTable &nodes, OutputBuffer &out) {
+    // Convert the node from integer naming to original string name
+    // If the node is not present in the table, then it does not have any edge in the network
+    // So, its name is unkown and it is printed as "-"
+    out.pad(nodes.name(i), 15);
+    out.put("  |  ");
+
+    // If node is unreachable from the source node
+    if (distance[i] == INF) {
+        out.pad("INF", 15);
+        out.put("  |  ");
+        out.put("-");
+    } else {
+        out.pad(distance[i], 15);
+        out.put("  |  ");
+
+        // Measure the least cost path by going from node to its parent till we reach the source node
+        // then write it backwards in place, with the source node first
+        size_t length = 0;
+        for (ll v = i; v != -1; v = parent[v]) {
+            length += nodes.name(v).size() + (v == i ? 0 : 4);
+        }
+        char *end = out.extend(length) + length;
+        for (ll v = i; v != -1; v = parent[v]) {
+            if (v != i) {
+                end -= 4;
+                memcpy(end, " -> ", 4);
+            }
+            string_view name = nodes.name(v);
+            end -= name.size();
+            memcpy(end, name.data(), name.size());
+        }
+    }
+    out.put("\n");
+}
+
+// Pretty prints the results obtained from the Dijkstra algorithm to the given stream
+// Output the least cost path from source node to every node in the network along with the path price
+// The source node comes first, followed by all the other nodes in the order of their integer names
+void printResults(ll sNode, const vector<ll> &distance, const vector<ll> &parent, const NodeTable &nodes, ostream &os) {
+    OutputBuffer out(os);
+    out.put("Distance of Nodes from the source node: ");
+    out.put(nodes.name(sNode));
+    out.put("\n\n");
+    out.pad("Node", 15);
+    out.put("  |  ");
+    out.pad("Path Price", 15);
+    out.put("  |  ");
+    out.put("Shortest Path\n");
+    out.put(string(74, '='));
+    out.put("\n");
+
+    // Iterating all the nodes in the network
+    for (ll k = -1; k < (ll)distance.size(); ++k) {
+        // The source node is printed first
+        if (k == sNode) continue;
+        ll i = k == -1 ? sNode : k;
+
+        printRow(i, distance, parent, nodes, out);
+    }
+}
+
+// Finds the first hop from the source node on the least cost path of every node in one pass over the parents
+// The hop of a node is the one of its parent, unless the parent is the source node, so every chain of parents
+// is only walked up to the first node whose hop is known and then all the nodes of the walk get its hop
+// The source node and the unreachable nodes have no next hop (-1)
+void nextHops(ll sNode, const vector<ll> &parent, vector<ll> &hop) {
+    ll numNodes = parent.size();
+    hop.assign(numNodes, -2);  // -2 while the hop is not known yet
+    hop[sNode] = -1;
+    for (ll v = 0; v < numNodes; ++v) {
+        ll u = v;
+        while (hop[u] == -2 && parent[u] != -1 && parent[u] != sNode) u = parent[u];
+        ll h = hop[u] != -2 ? hop[u] : parent[u] == sNode ? u : -1;
+        for (ll x = v; x != -1 && hop[x] == -2; x = parent[x]) hop[x] = h;
+    }
+}
+
+// Identifies the binary next-hop tables
+#define NEXT_HOP_MAGIC "L4HOPS1"
+
+// The header of the binary next-hop table of a source node. It is followed by the distance of every node
+// (64 bits, -1 if unreachable) and then its next hop (32 bits, UINT32_MAX if none), both indexed by the
+// integers of the nodes, which are the positions of their names in the snapshot of the graph
+class NextHopHeader {
+   public:
+    // NEXT_HOP_MAGIC along with its terminating null character
+    char magic[8];
+
+    // The number of nodes and the source node
+    uint32_t numNodes, source;
+};
+
+// Writes the next-hop table of the source node to the given stream in the CSV or the binary format
+// The CSV lines of the named nodes come in the order of their integer names, the distance and the next hop
+// being empty for the unreachable nodes and the next hop also for the source node. The header line is not written
+void writeNextHops(ll sNode, const vector<ll> &distance, const vector<ll> &parent, const NodeTable &nodes, OutputFormat format, ostream &os) {
+    vector<ll> hop;
+    nextHops(sNode, parent, hop);
+    OutputBuffer out(os);
+
+    if (format == OutputFormat::BINARY) {
+        NextHopHeader header{};
+        memcpy(header.magic, NEXT_HOP_MAGIC, sizeof(header.magic));
+        header.numNodes = distance.size();
+        header.source = sNode;
+        out.write(&header, sizeof(header));
+        for (ll d : distance) {
+            int64_t value = d == INF ? -1 : d;
+            out.write(&value, sizeof(value));
+        }
+        for (ll h : hop) {
+            uint32_t value = h == -1 ? UINT32_MAX : h;
+            out.write(&value, sizeof(value));
+        }
+        return;
+    }
+
+    for (ll v = 0; v < nodes.size(); ++v) {
+        out.put(nodes.name(sNode));
+        out.put(",");
+        out.put(nodes.name(v));
+        out.put(",");
+        if (distance[v] != INF) out.put(distance[v]);
+        out.put(",");
+        if (hop[v] != -1) out.put(nodes.name(hop[v]));
+        out.put("\n");
+    }
+}
+
+// Records all the equal-cost predecessors of every node from the distances of the scratch buffers, i.e. the
+// shortest path DAG of the source node. The neighbor `u` of `v` is a predecessor when some edge between them
+// is tight, `distance[u] + w == distance[v]`. Works from the distances alone, so it follows any of the kernels
+// The edge weights are positive, so the DAG has no cycle and the predecessors of a node are all closer to the source
+void equalCostDag(const Graph &gr, SpfScratch &s) {
+    ll numNodes = gr.numNodes();
+    s.predOffset.assign(numNodes + 1, 0);
+    s.preds.clear();
+    for (ll v = 0; v < numNodes; ++v) {
+        s.predOffset[v] = s.preds.size();
+        if (s.distance[v] == INF) continue;
+        for (uint32_t j = gr.offset[v]; j < gr.offset[v + 1]; ++j) {
+            uint32_t u = gr.adj[j];
+            // The parallel edges of the same weight give the same predecessor once
+            if (s.distance[u] + gr.weight[j] == s.distance[v] && find(s.preds.begin() + s.predOffset[v], s.preds.end(), u) == s.preds.end()) {
+                s.preds.emplace_back(u);
+            }
+        }
+        sort(s.preds.begin() + s.predOffset[v], s.preds.end());
+    }
+    s.predOffset[numNodes] = s.preds.size();
+}
+
+// Pretty prints the equal-cost multipath routing table of the source node from its shortest path DAG
+// Every node has the number of its least cost paths and the set of next hops of the source node on them,
+// across which its traffic can be balanced. The counts saturate at INF on the graphs with too many paths
+void printEcmpResults(ll sNode, const SpfScratch &s, const NodeTable &nodes, ostream &os) {
+    ll numNodes = s.distance.size();
+
+    // The nodes reachable from the source node in the order of their distance, so that
+    // the predecessors of every node are handled before it
+    vector<uint32_t> order;
+    for (ll v = 0; v < numNodes; ++v) {
+        if (s.distance[v] != INF) order.emplace_back(v);
+    }
+    sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return s.distance[a] < s.distance[b]; });
+
+    // The number of least cost paths and the sorted next hops of every node
+    vector<ll> numPaths(numNodes, 0);
+    vector<vector<uint32_t>> nextHops(numNodes);
+    numPaths[sNode] = 1;
+    for (uint32_t v : order) {
+        for (uint32_t j = s.predOffset[v]; j < s.predOffset[v + 1]; ++j) {
+            uint32_t u = s.preds[j];
+            numPaths[v] = min(INF, numPaths[v] + numPaths[u]);
+            // The neighbors of the source node reached through their direct link are their own next hop
+            const vector<uint32_t> &hops = u == sNode ? vector<uint32_t>{v} : nextHops[u];
+            vector<uint32_t> merged;
+            set_union(nextHops[v].begin(), nextHops[v].end(), hops.begin(), hops.end(), back_inserter(merged));
+            nextHops[v].swap(merged);
+        }
+    }
+
+    os << "Equal-cost paths of Nodes from the source node: " << nodes.name(sNode) << "\n\n";
+    prettyPrint(os, "Node", 15);
+    os << "  |  ";
+    prettyPrint(os, "Path Price", 15);
+    os << "  |  ";
+    prettyPrint(os, "Paths", 20);
+    os << "  |  ";
+    os << "Next Hops\n";
+    prettyPrint(os, "\n", 80, std::right, '=');
+
+    // The source node is printed first, followed by all the other nodes in the order of their integer names
+    for (ll k = -1; k < numNodes; ++k) {
+        if (k == sNode) continue;
+        ll i = k == -1 ? sNode : k;
+
+        prettyPrint(os, nodes.name(i), 15);
+        os << "  |  ";
+        if (s.distance[i] == INF) {
+            prettyPrint(os, "INF", 15);
+        } else {
+            prettyPrint(os, s.distance[i], 15);
+        }
+        os << "  |  ";
+        if (numPaths[i] == INF) {
+            prettyPrint(os, "INF", 20);
+        } else {
+            prettyPrint(os, numPaths[i], 20);
+        }
+        os << "  |  ";
+        if (nextHops[i].empty()) os << "-";
+        for (size_t j = 0; j < nextHops[i].size(); ++j) {
+            if (j != 0) os << ", ";
+            os << nodes.name(nextHops[i][j]);
+        }
+        os << "\n";
+    }
+}
+
+// Computes the routing table of every node of the network from a single load of the graph
+// The sources are processed in batches, the threads running the Dijkstra algorithm with their own scratch buffers
+// and formatting the tables, which are then written to the standard output in the order of the nodes
+// Adds the work done by the runs of all the threads to the given counters
+void allSources(const Graph &gr, const NodeTable &nodes, const Options &opts, SpfCounters &counters) {
+    ll numSources = nodes.size();
+    vector<SpfScratch> scratch(opts.threads, SpfScratch(opts.arity));
+
+    // The threads already share the sources, so every source runs the sequential kernel
+    Options seqOpts = opts;
+    seqOpts.kernel = SpfKernel::DIJKSTRA;
+
+    // The CSV lines of all the sources share a single header
+    if (opts.output == OutputFormat::CSV) std::cout << "source,destination,distance,next_hop\n";
+
+    // The formatted routing tables of the current batch
+    ll batchSize = opts.threads * SOURCES_PER_THREAD;
+    vector<string> tables(batchSize);
+
+    for (ll first = 0; first < numSources; first += batchSize) {
+        ll count = min(batchSize, numSources - first);
+        parallelFor(count, opts.threads, [&](ll i, ll t) {
+            dijkstra(first + i, gr, seqOpts, scratch[t]);
+            ostringstream os;
+            if (opts.output == OutputFormat::PATHS) {
+                printResults(first + i, scratch[t].distance, scratch[t].parent, nodes, os);
+            } else {
+                writeNextHops(first + i, scratch[t].distance, scratch[t].parent, nodes, opts.output, os);
+            }
+            tables[i] = os.str();
+        });
+
+        // Write the tables, separated by an empty line when they are printed for humans
+        for (ll i = 0; i < count; ++i) {
+            if (first + i != 0 && opts.output == OutputFormat::PATHS) std::cout << "\n";
+            std::cout << tables[i];
+            string().swap(tables[i]);
+        }
+    }
+    for (const SpfScratch &s : scratch) counters += s.counters;
+}
+
+// Sets the weight of all the edges between the nodes `u` and `v` to `w` in the adjacency lists of both the nodes
+// Returns the smallest of their old weights, or INF if there is no edge between the nodes
+ll setLinkWeight(Graph &gr, ll u, ll v, ll w) {
+    ll oldW = INF;
+    for (ll x : {u, v}) {
+        ll y = x == u ? v : u;
+        for (uint32_t j = gr.offset[x]; j < gr.offset[x + 1]; ++j) {
+            if (gr.adj[j] != y) continue;
+            oldW = min(oldW, (ll)gr.weight[j]);
+            gr.weight[j] = w;
+        }
+    }
+    return oldW;
+}
+
+// Incremental maintenance of the shortest path tree of a source node when the cost of a link changes
+// After the initial run of the Dijkstra algorithm, the parent of every node is its neighbor on a least cost path
+// having the smallest (distance, integer name), as that neighbor is visited first. So once the distances
+// are repaired, the parents are recomputed by the same rule only around the nodes whose distance changed,
+// which gives exactly the tree a fresh run of the Dijkstra algorithm would give
+class DynamicSpt {
+   public:
+    // Constructor, the scratch buffers hold the results of a run of the Dijkstra algorithm from the source node
+    DynamicSpt(Graph &gr, ll sourceNode, SpfScratch &s)
+        : gr{gr}, source{sourceNode}, distance{s.distance}, parent{s.parent}, heap{s.heap}, counters{s.counters}, stamp(gr.numNodes(), 0), inTree(gr.numNodes(), false), numUpdates{0} {}
+
+    // Sets the weight of all the edges between the nodes `u` and `v` to `w` and repairs the tree
+    // Fills the nodes whose distance or parent changed. Returns false if there is no edge between the nodes
+    bool update(ll u, ll v, ll w, vector<ll> &changed) {
+        ++numUpdates;
+        changed.clear();
+        touched.clear();
+
+        // Change the weight of the edges in the adjacency lists of both the nodes
+        ll oldW = setLinkWeight(gr, u, v, w);
+        if (oldW == INF) return false;
+
+        if (w < oldW) {
+            decrease(u, v, w);
+        } else if (w > oldW) {
+            increase(u, v);
+        }
+
+        // Recompute the parents of the ends of the link, and of the nodes whose distance changed and their neighbors
+        vector<ll> repair{u, v};
+        for (size_t k = 0; k < touched.size(); ++k) {
+            ll x = touched[k].node;
+            if (distance[x] == touched[k].distance) continue;
+            repair.emplace_back(x);
+            for (uint32_t j = gr.offset[x]; j < gr.offset[x + 1]; ++j) repair.emplace_back(gr.adj[j]);
+        }
+        for (ll x : repair) {
+            ll p = bestParent(x);
+            if (p != parent[x]) {
+                save(x);
+                parent[x] = p;
+            }
+        }
+
+        // Report the nodes whose route changed
+        for (const Saved &e : touched) {
+            if (distance[e.node] != e.distance || parent[e.node] != e.parent) changed.emplace_back(e.node);
+        }
+        sort(changed.begin(), changed.end());
+        return true;
+    }
+
+   private:
+    // The old distance and parent of a node changed by the current update
+    class Saved {
+       public:
+        ll node, distance, parent;
+    };
+
+    // The graph and the source node of the tree
+    Graph &gr;
+    ll source;
+
+    // The distance and the parent of every node in the tree
+    vector<ll> &distance, &parent;
+
+    // The heap used to propagate the changed distances
+    IndexedHeap &heap;
+
+    // The work done by the repairs, added to the one of the run which built the tree
+    SpfCounters &counters;
+
+    // The update in which every node was saved last, and whether it is in the subtree being recomputed
+    vector<ll> stamp;
+    vector<bool> inTree;
+
+    // The number of updates so far, and the nodes saved in the current update
+    ll numUpdates;
+    vector<Saved> touched;
+
+    // Saves the distance and parent of the node before the current update changes them for the first time
+    void save(ll x) {
+        if (stamp[x] == numUpdates) return;
+        stamp[x] = numUpdates;
+        touched.push_back(Saved{x, distance[x], parent[x]});
+    }
+
+    // Returns the parent of the node by the rule of the Dijkstra algorithm, -1 for the source and unreachable nodes
+    ll bestParent(ll x) const {
+        if (x == source || distance[x] == INF) return -1;
+        ll p = -1;
+        for (uint32_t j = gr.offset[x]; j < gr.offset[x + 1]; ++j) {
+            ll y = gr.adj[j];
+            if (distance[y] == INF || distance[y] + gr.weight[j] != distance[x]) continue;
+            if (p == -1 || make_pair(distance[y], y) < make_pair(distance[p], p)) p = y;
+        }
+        return p;
+    }
+
+    // Runs the Dijkstra algorithm from the nodes in the heap, relaxing the edges only towards the nodes
+    // accepted by `allowed`. All the distances outside the heap are final
+    template <typename Allowed>
+    void propagate(Allowed allowed) {
+        while (!heap.empty()) {
+            ll x = heap.pop().second;
+            ++counters.pops;
+            for (uint32_t j = gr.offset[x]; j < gr.offset[x + 1]; ++j) {
+                ll y = gr.adj[j], d = distance[x] + gr.weight[j];
+                ++counters.relaxations;
+                if (allowed(y) && d < distance[y]) {
+                    save(y);
+                    distance[y] = d;
+                    heap.push(y, d);
+                    ++counters.decreases;
+                    ++counters.pushes;
+                }
+            }
+        }
+    }
+
+    // Repairs the distances when the link u-v becomes cheaper. Only the nodes which get closer
+    // through the link change, and they are found by a Dijkstra search starting from the ends of the link
+    void decrease(ll u, ll v, ll w) {
+        heap.reset(gr.numNodes());
+        for (auto [x, y] : {make_pair(u, v), make_pair(v, u)}) {
+            ++counters.relaxations;
+            if (distance[x] != INF && distance[x] + w < distance[y]) {
+                save(y);
+                distance[y] = distance[x] + w;
+                heap.push(y, distance[y]);
+                ++counters.decreases;
+                ++counters.pushes;
+            }
+        }
+        propagate([](ll) { return true; });
+    }
+
+    // Repairs the distances when the link u-v becomes costlier. Only the subtree hanging below the link
+    // can get farther, so its nodes are reattached from their neighbors outside of it and the distances
+    // are recomputed by a Dijkstra search restricted to the subtree
+    void increase(ll u, ll v) {
+        ll root = parent[v] == u ? v : parent[u] == v ? u : -1;
+        if (root == -1) return;  // The link is not in the tree, so no distance changes
+
+        // Collect the subtree by walking down from its root along the parent links
+        vector<ll> subtree{root};
+        inTree[root] = true;
+        for (size_t k = 0; k < subtree.size(); ++k) {
+            ll x = subtree[k];
+            for (uint32_t j = gr.offset[x]; j < gr.offset[x + 1]; ++j) {
+                ll y = gr.adj[j];
+                if (!inTree[y] && parent[y] == x) {
+                    inTree[y] = true;
+                    subtree.emplace_back(y);
+                }
+            }
+        }
+
+        // Reattach every node of the subtree through its best neighbor outside of it
+        for (ll x : subtree) {
+            save(x);
+            distance[x] = INF;
+        }
+        heap.reset(gr.numNodes());
+        for (ll x : subtree) {
+            for (uint32_t j = gr.offset[x]; j < gr.offset[x + 1]; ++j) {
+                ll y = gr.adj[j];
+                ++counters.relaxations;
+                if (!inTree[y] && distance[y] != INF && distance[y] + gr.weight[j] < distance[x]) {
+                    distance[x] = distance[y] + gr.weight[j];
+                    ++counters.decreases;
+                }
+            }
+            if (distance[x] != INF) {
+                heap.push(x, distance[x]);
+                ++counters.pushes;
+            }
+        }
+        propagate([this](ll y) { return (bool)inTree[y]; });
+
+        for (ll x : subtree) inTree[x] = false;
+    }
+};
+
+// Reads the link cost updates `<u> <v> <newWeight>` from the given file ("-" for the standard input)
+// and applies them one by one to the shortest path tree of the source node, printing the changed routes
+// and the time taken by every update
+void dynamicSpf(ll sNode, Graph &gr, const NodeTable &nodes, SpfScratch &scratch, const string &fileName) {
+    ifstream inFile;
+    if (fileName != "-") {
+        inFile.open(fileName, ios::in);
+        // If the file was not able to open, exit with failure status
+        if (!inFile) {
+            std::cout << "File '" << fileName << "' could not be opened!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    istream &in = fileName == "-" ? std::cin : inFile;
+
+    DynamicSpt spt(gr, sNode, scratch);
+    vector<ll> changed;
+
+    // The vertices and the new weight of the link
+    string u, v, w;
+    while (in >> u >> v >> w) {
+        ll wl;
+        try {
+            // Try converting weight to long long integer
+            wl = stringToLong(w);
+
+            // For this question weight should be a positive integer
+            // less than 10000
+            if (wl <= 0 || wl >= MAX_EDGE_WEIGHT) throw exception();
+        } catch (exception &e) {
+            std::cout << "The weight of an edge between two nodes should be a positive integer less than 10,000, but got '" << w << "'\n";
+            exit(EXIT_FAILURE);
+        }
+
+        ll ui = nodes.find(u), vi = nodes.find(v);
+        auto start = chrono::steady_clock::now();
+        if (ui == -1 || vi == -1 || !spt.update(ui, vi, wl, changed)) {
+            std::cout << "There is no link between the nodes '" << u << "' and '" << v << "' in the network\n";
+            exit(EXIT_FAILURE);
+        }
+        auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+
+        // Print the routes changed by the update
+        std::cout << "\nUpdate " << u << " - " << v << " to weight " << wl << ": " << changed.size() << " route(s) changed in " << elapsed.count() << " us\n";
+        OutputBuffer out(std::cout);
+        for (ll x : changed) {
+            printRow(x, scratch.distance, scratch.parent, nodes, out);
+        }
+    }
+}
+
+// Search state of the point-to-point queries over one direction of the graph
+// The state of a node is valid only in the query which stamped it last, so a query costs only
+// as much as the nodes it touches and the buffers are never cleared between the queries
+class SearchSpace {
+   public:
+    // The tentative distance, the parent and the potential of every node in the current query
+    vector<ll> distance, parent, potential;
+
+    // The heap of the nodes reached but not settled yet
+    IndexedHeap heap;
+
+    // The number of nodes settled in the current query
+    ll numSettled;
+
+    // The work done by all the queries using this search space, a pop being a settled node
+    SpfCounters counters;
+
+    // Constructor
+    SearchSpace(ll numNodes) : distance(numNodes), parent(numNodes), potential(numNodes), numSettled{0}, reached(numNodes, 0), settled(numNodes, 0), query{0} {}
+
+    // Starts a new query from the given node
+    void reset(ll sourceNode) {
+        ++query;
+        numSettled = 0;
+        heap.reset(distance.size());
+        reach(sourceNode, 0, -1);
+    }
+
+    // Whether the node has been reached in the current query
+    bool isReached(ll v) const {
+        return reached[v] == query;
+    }
+
+    // Whether the node has been settled in the current query
+    bool isSettled(ll v) const {
+        return settled[v] == query;
+    }
+
+    // Returns the distance of the node in the current query
+    ll dist(ll v) const {
+        return isReached(v) ? distance[v] : INF;
+    }
+
+    // Marks the node as reached with the given distance and parent, the caller pushes it into the heap
+    void reach(ll v, ll d, ll p) {
+        if (!isReached(v)) {
+            reached[v] = query;
+            potential[v] = -1;
+        }
+        distance[v] = d;
+        parent[v] = p;
+    }
+
+    // Pushes the node into the heap with the given key
+    void push(ll v, ll key) {
+        heap.push(v, key);
+        ++counters.pushes;
+    }
+
+    // Marks the node as settled
+    void settle(ll v) {
+        settled[v] = query;
+        ++numSettled;
+        ++counters.pops;
+    }
+
+   private:
+    // The query in which every node was reached and settled last, and the current query
+    vector<ll> reached, settled;
+    ll query;
+};
+
+// A path between two nodes along with its price
+class Route {
+   public:
+    ll distance;
+    vector<ll> path;
+};
+
+// Answers the point-to-point shortest path queries over the graph
+// Supports the plain Dijkstra algorithm stopping at the destination, the bidirectional Dijkstra algorithm,
+// and the A* search with landmark lower bounds (ALT). The landmarks are chosen by repeatedly taking
+// the node farthest from the landmarks chosen so far, and their distance tables are computed at load time
+class QueryEngine {
+   public:
+    // Constructor, precomputes the distances from the landmarks
+    QueryEngine(const Graph &gr, const Options &opts)
+        : gr{gr}, opts{opts}, scratch(opts.arity), forward(gr.numNodes()), backward(gr.numNodes()), numLandmarks{opts.landmarks} {
+        chooseLandmarks();
+    }
+
+    // Finds the shortest path between the nodes `s` and `t` with the given algorithm
+    // Returns the distance and fills the path, which is empty if `t` is not reachable from `s`
+    // Also returns the number of nodes settled by the search
+    ll query(QueryAlgo algo, ll s, ll t, vector<ll> &path, ll &numSettled) {
+        if (algo == QueryAlgo::FULL) {
+            // The full single source run of the Dijkstra algorithm settles every node reachable from `s`
+            dijkstra(s, gr, opts, scratch);
+            numSettled = count(scratch.visited.begin(), scratch.visited.end(), true);
+            path.clear();
+            if (scratch.distance[t] != INF) {
+                for (ll v = t; v != -1; v = scratch.parent[v]) path.emplace_back(v);
+                reverse(path.begin(), path.end());
+            }
+            return scratch.distance[t];
+        }
+
+        ll d = algo == QueryAlgo::BIDIR ? bidirectional(s, t, path) : aStar(s, t, path, [](ll, ll) { return true; }, [&](ll v) { return lowerBound(v, t); });
+        numSettled = forward.numSettled + backward.numSettled;
+        return d;
+    }
+
+    // Returns the work done by all the searches of the engine, including the full runs and the landmarks
+    SpfCounters counters() const {
+        SpfCounters c = scratch.counters;
+        c += forward.counters;
+        c += backward.counters;
+        return c;
+    }
+
+    // Finds the `k` least cost loopless paths between the nodes `s` and `t` with Yen's algorithm, in the order
+    // of their price. Every later path leaves an earlier one at some spur node, so for every node of the last
+    // path found, the search from it avoids the nodes before it and the links leaving it along the paths found
+    // with the same prefix. Only the spur nodes from the one at which the last path left its parent are tried,
+    // as the earlier ones were already tried with the same prefix (Lawler's improvement)
+    // Removing nodes and links only lengthens the distances, so the exact distances to `t` in the full graph,
+    // from a single run of the Dijkstra algorithm, are the potentials of A* spur searches which settle little
+    // more than the nodes of the paths they find. The search space is reused by all of them without clearing it
+    // Fills the paths, fewer than `k` if there are no more, and returns the total number of nodes settled
+    ll kShortest(ll s, ll t, ll k, vector<Route> &routes) {
+        routes.clear();
+        if (banned.empty()) banned.assign(gr.numNodes(), 0);
+
+        // The graph is undirected, so the distances from `t` are the distances to it
+        // The full run is counted as settling every node
+        dijkstra(t, gr, opts, scratch);
+        ll numSettled = gr.numNodes();
+        const vector<ll> &toTarget = scratch.distance;
+        auto bound = [&](ll v) { return toTarget[v]; };
+
+        Route route;
+        route.distance = aStar(s, t, route.path, [](ll, ll) { return true; }, bound);
+        numSettled += forward.numSettled;
+        if (route.distance == INF) return numSettled;
+        routes.emplace_back(route);
+
+        // The candidate paths found by the spur searches, ordered by their price, with the position of
+        // their spur node. A map also drops the same path found from two different spur nodes
+        map<pair<ll, vector<ll>>, size_t> candidates;
+
+        // The path found by the current spur search and the nodes the links from the spur node should not reach
+        vector<ll> spurPath, bannedNext;
+        size_t deviation = 0;
+        while ((ll)routes.size() < k) {
+            const vector<ll> last = routes.back().path;
+            ll rootDistance = 0;
+            for (size_t j = 0; j + 1 < last.size(); ++j) {
+                ll spur = last[j];
+                if (j >= deviation) {
+                    // Avoid the nodes of the root path leading to the spur node
+                    ++banStamp;
+                    for (size_t x = 0; x < j; ++x) banned[last[x]] = banStamp;
+
+                    // Avoid the links along which the paths already found leave the same root path
+                    bannedNext.clear();
+                    for (const Route &r : routes) {
+                        if (r.path.size() > j + 1 && equal(last.begin(), last.begin() + j + 1, r.path.begin())) bannedNext.emplace_back(r.path[j + 1]);
+                    }
+
+                    auto allowed = [&](ll u, ll v) {
+                        return banned[v] != banStamp && (u != spur || find(bannedNext.begin(), bannedNext.end(), v) == bannedNext.end());
+                    };
+                    ll d = aStar(spur, t, spurPath, allowed, bound);
+                    numSettled += forward.numSettled;
+                    if (d != INF) {
+                        vector<ll> path(last.begin(), last.begin() + j);
+                        path.insert(path.end(), spurPath.begin(), spurPath.end());
+                        candidates.emplace(make_pair(rootDistance + d, move(path)), j);
+                    }
+                }
+                rootDistance += linkWeight(spur, last[j + 1]);
+            }
+
+            // The cheapest candidate is the next path
+            if (candidates.empty()) break;
+            routes.push_back({candidates.begin()->first.first, candidates.begin()->first.second});
+            deviation = candidates.begin()->second;
+            candidates.erase(candidates.begin());
+        }
+        return numSettled;
+    }
+
+   private:
+    // The graph and the options of the Dijkstra algorithm
+    const Graph &gr;
+    const Options &opts;
+
+    // The scratch buffers of the full runs, and the search spaces of both the directions
+    SpfScratch scratch;
+    SearchSpace forward, backward;
+
+    // The number of landmarks and the distance of every node from every landmark
+    // The distances of the node `v` are `landmarkDist[v * numLandmarks]` onwards
+    ll numLandmarks;
+    vector<ll> landmarkDist;
+
+    // The nodes banned from the current spur search of Yen's algorithm are stamped with its number
+    vector<ll> banned;
+    ll banStamp = 0;
+
+    // Chooses the landmarks and fills their distance tables
+    void chooseLandmarks() {
+        ll numNodes = gr.numNodes();
+        landmarkDist.assign(numNodes * numLandmarks, INF);
+        if (numLandmarks == 0) return;
+
+        // The distance of every node from its closest landmark, nodes unreachable from all of them being the farthest
+        vector<ll> closest(numNodes, INF);
+
+        // Start from the node farthest from the node 0
+        dijkstra(0, gr, opts, scratch);
+        ll landmark = farthest(scratch.distance);
+        if (landmark == -1) return;
+        for (ll l = 0; l < numLandmarks; ++l) {
+            dijkstra(landmark, gr, opts, scratch);
+            for (ll v = 0; v < numNodes; ++v) {
+                landmarkDist[v * numLandmarks + l] = scratch.distance[v];
+                closest[v] = min(closest[v], scratch.distance[v]);
+            }
+            landmark = farthest(closest);
+        }
+    }
+
+    // Returns the node having the largest distance, the unreachable nodes counting as the farthest
+    // The nodes without any edge are never taken, returns -1 if there is no other node
+    ll farthest(const vector<ll> &distance) const {
+        ll f = -1;
+        for (ll v = 0; v < gr.numNodes(); ++v) {
+            if (gr.offset[v] != gr.offset[v + 1] && (f == -1 || distance[v] > distance[f])) f = v;
+        }
+        return f;
+    }
+
+    // Returns the lower bound on the distance between the nodes `v` and `t` given by the landmarks
+    ll lowerBound(ll v, ll t) const {
+        if (numLandmarks == 0) return 0;
+        const ll *dv = &landmarkDist[v * numLandmarks], *dt = &landmarkDist[t * numLandmarks];
+        ll bound = 0;
+        for (ll l = 0; l < numLandmarks; ++l) {
+            // A landmark bounds the distance only if it reaches both the nodes
+            if (dv[l] == INF || dt[l] == INF) continue;
+            bound = max(bound, abs(dv[l] - dt[l]));
+        }
+        return bound;
+    }
+
+    // Returns the smallest weight of the edges between the nodes `u` and `v`
+    ll linkWeight(ll u, ll v) const {
+        ll w = INF;
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            if (gr.adj[j] == v) w = min(w, (ll)gr.weight[j]);
+        }
+        return w;
+    }
+
+    // Follows the parent links of the search space from the node back to its source, appending the nodes to the path
+    static void unwind(const SearchSpace &ss, ll v, vector<ll> &path) {
+        for (; v != -1; v = ss.parent[v]) path.emplace_back(v);
+    }
+
+    // Runs the Dijkstra algorithm from `s` till `t` is settled, keying the nodes by their distance plus
+    // the lower bound of their distance to `t` given by the landmarks. This is the A* search with consistent
+    // potentials, so every node is settled at most once. Only the edges `(u, v)` with `allowed(u, v)` are followed,
+    // and `bound(v)` gives the lower bound of the distance from `v` to `t`, INF for the nodes not reaching `t`
+    template <typename Allowed, typename Bound>
+    ll aStar(ll s, ll t, vector<ll> &path, Allowed allowed, Bound bound) {
+        path.clear();
+        backward.numSettled = 0;
+        forward.reset(s);
+        forward.push(s, 0);
+
+        while (!forward.heap.empty()) {
+            ll u = forward.heap.pop().second;
+            forward.settle(u);
+            if (u == t) break;
+
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                ll v = gr.adj[j], d = forward.distance[u] + gr.weight[j];
+                ++forward.counters.relaxations;
+                if (forward.isSettled(v) || d >= forward.dist(v) || !allowed(u, v)) continue;
+                forward.reach(v, d, u);
+                ++forward.counters.decreases;
+                if (forward.potential[v] == -1) forward.potential[v] = bound(v);
+                if (forward.potential[v] != INF) forward.push(v, d + forward.potential[v]);
+            }
+        }
+
+        if (!forward.isSettled(t)) return INF;
+        unwind(forward, t, path);
+        reverse(path.begin(), path.end());
+        return forward.distance[t];
+    }
+
+    // Runs the Dijkstra algorithm from both `s` and `t` at once, always advancing the side with the smaller key
+    // Stops when the sum of the smallest keys of both the sides reaches the best path found through a meeting edge
+    ll bidirectional(ll s, ll t, vector<ll> &path) {
+        path.clear();
+        forward.reset(s);
+        forward.push(s, 0);
+        backward.reset(t);
+        backward.push(t, 0);
+
+        // The best distance found so far, and the ends of the meeting edge of that path on both the sides
+        ll best = s == t ? 0 : INF, endF = s, endB = t;
+
+        while (!forward.heap.empty() && !backward.heap.empty()) {
+            if (forward.heap.top().first + backward.heap.top().first >= best) break;
+
+            // Advance the side with the smaller key
+            bool isForward = forward.heap.top().first <= backward.heap.top().first;
+            SearchSpace &ss = isForward ? forward : backward;
+            const SearchSpace &other = isForward ? backward : forward;
+
+            ll u = ss.heap.pop().second;
+            ss.settle(u);
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                ll v = gr.adj[j], d = ss.distance[u] + gr.weight[j];
+                ++ss.counters.relaxations;
+                if (d < ss.dist(v)) {
+                    ss.reach(v, d, u);
+                    ss.push(v, d);
+                    ++ss.counters.decreases;
+                }
+                // Check the path through this edge when the other side has reached its end
+                if (other.isReached(v) && d + other.distance[v] < best) {
+                    best = d + other.distance[v];
+                    endF = isForward ? u : v;
+                    endB = isForward ? v : u;
+                }
+            }
+        }
+
+        if (best == INF) return INF;
+
+        // Join the path from `s` to the meeting edge with the path from the meeting edge to `t`
+        unwind(forward, endF, path);
+        reverse(path.begin(), path.end());
+        if (endF == endB) path.pop_back();
+        unwind(backward, endB, path);
+        return best;
+    }
+};
+
+// Reads the queries `<src> <dst>` from the given file ("-" for the standard input) and answers them
+// with `query(s, t, routes)`, which fills the least cost paths found and returns the number of settled nodes
+// Prints every path found for the query, or a single unreachable row, with the number of nodes settled to find them
+template <typename Query>
+void answerQueries(const string &fileName, const NodeTable &nodes, Query query) {
+    ifstream inFile;
+    if (fileName != "-") {
+        inFile.open(fileName, ios::in);
+        // If the file was not able to open, exit with failure status
+        if (!inFile) {
+            std::cout << "File '" << fileName << "' could not be opened!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    istream &in = fileName == "-" ? std::cin : inFile;
+
+    prettyPrint(std::cout, "Source", 15);
+    std::cout << "  |  ";
+    prettyPrint(std::cout, "Destination", 15);
+    std::cout << "  |  ";
+    prettyPrint(std::cout, "Path Price", 15);
+    std::cout << "  |  ";
+    prettyPrint(std::cout, "Settled", 15);
+    std::cout << "  |  ";
+    std::cout << "Shortest Path\n";
+    prettyPrint(std::cout, "\n", 111, std::right, '=');
+
+    // The total number of queries, settled nodes and the time taken by them
+    ll numQueries = 0, totalSettled = 0;
+    chrono::nanoseconds totalTime{0};
+
+    string src, dst;
+    vector<Route> routes;
+    while (in >> src >> dst) {
+        for (const string &name : {src, dst}) {
+            if (nodes.find(name) == -1) {
+                std::cout << "Node '" << name << "' is not present in the network\n";
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        auto start = chrono::steady_clock::now();
+        ll numSettled = query(nodes.find(src), nodes.find(dst), routes);
+        totalTime += chrono::steady_clock::now() - start;
+        ++numQueries;
+        totalSettled += numSettled;
+
+        // An unreachable destination is printed as a path of price INF
+        if (routes.empty()) routes.push_back({INF, {}});
+        for (const Route &route : routes) {
+            prettyPrint(std::cout, src, 15);
+            std::cout << "  |  ";
+            prettyPrint(std::cout, dst, 15);
+            std::cout << "  |  ";
+            if (route.distance == INF) {
+                prettyPrint(std::cout, "INF", 15);
+            } else {
+                prettyPrint(std::cout, route.distance, 15);
+            }
+            std::cout << "  |  ";
+            prettyPrint(std::cout, numSettled, 15);
+            std::cout << "  |  ";
+            if (route.path.empty()) std::cout << "-";
+            for (size_t j = 0; j < route.path.size(); ++j) {
+                std::cout << nodes.name(route.path[j]);
+                if (j + 1 != route.path.size()) std::cout << " -> ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    std::cout << "\nAnswered " << numQueries << " queries in " << totalTime.count() / 1000 << " us, settling "
+              << (numQueries == 0 ? 0 : totalSettled / numQueries) << " nodes per query on average\n";
+}
+
+// Answers the point-to-point queries of the given file over the graph with the chosen algorithm
+// With more than one path asked for, every query is answered by Yen's algorithm over the A* searches instead
+// Adds the work done by all the searches to the given counters
+void runQueries(const Graph &gr, const NodeTable &nodes, const Options &opts, SpfCounters &counters) {
+    // Precompute the landmarks when loading the graph
+    auto start = chrono::steady_clock::now();
+    QueryEngine engine(gr, opts);
+    auto elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+    std::cout << "Preprocessed " << opts.landmarks << " landmark(s) in " << elapsed.count() << " us\n\n";
+
+    answerQueries(opts.queries, nodes, [&](ll s, ll t, vector<Route> &routes) {
+        if (opts.kPaths > 1) return engine.kShortest(s, t, opts.kPaths, routes);
+
+        Route route;
+        ll numSettled;
+        route.distance = engine.query(opts.queryAlgo, s, t, route.path, numSettled);
+        routes.clear();
+        if (route.distance != INF) routes.emplace_back(move(route));
+        return numSettled;
+    });
+    counters += engine.counters();
+}
+
+// Maximum number of nodes settled by a witness search of the contraction hierarchy
+// The searches only estimating the priority of a node settle a tenth of it
+#define MAX_WITNESS_SETTLED 500
+
+// Identifies the contraction hierarchy files
+#define CH_MAGIC "L4CH0001"
+
+// An edge of the graph being contracted, `middle` is the node bypassed by a shortcut (-1 for an edge of the network)
+class ChEdge {
+   public:
+    ll to, weight, middle;
+};
+
+// Contraction hierarchy of the graph for fast repeated point-to-point queries
+// The nodes are contracted one by one in the order of their edge difference (shortcuts added minus edges removed,
+// plus the number of contracted neighbors to spread the contraction evenly). Contracting a node adds a shortcut
+// between two of its neighbors unless a witness search finds a path between them avoiding the node which is not
+// longer. Every edge is then kept only at its end contracted first, so a query is a bidirectional Dijkstra search
+// going only upwards from both the ends. The shortcuts remember the node they bypass so that the paths can be unpacked
+class ContractionHierarchy {
+   public:
+    // The upward graph in the CSR form, `middle` being the node bypassed by the edge (UINT32_MAX for an edge of the network)
+    vector<uint32_t> offset, adj, weight, middle;
+
+    // The number of nodes in the hierarchy
+    ll numNodes() const {
+        return (ll)offset.size() - 1;
+    }
+
+    // Contracts all the nodes of the graph and builds the upward graph. Returns the number of shortcuts added
+    ll build(const Graph &gr) {
+        ll n = gr.numNodes();
+
+        // Working copy of the graph keeping only the lightest of the parallel edges
+        work.assign(n, vector<ChEdge>());
+        for (ll u = 0; u < n; ++u) {
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) addEdge(u, gr.adj[j], gr.weight[j], -1);
+        }
+
+        contracted.assign(n, false);
+        deletedNeighbors.assign(n, 0);
+        position.assign(n, -1);
+        witness = SearchSpace(n);
+
+        // The contraction order, a lazily updated min-heap of the priorities of the nodes
+        vector<ll> priority(n);
+        priority_queue<pair<ll, ll>, vector<pair<ll, ll>>, greater<pair<ll, ll>>> pq;
+        for (ll v = 0; v < n; ++v) {
+            priority[v] = edgeDifference(v);
+            pq.emplace(priority[v], v);
+        }
+
+        // The rank of every node in the contraction order, and the edges removed with it
+        vector<ll> rank(n, -1);
+        vector<vector<ChEdge>> upward(n);
+        ll numShortcuts = 0, next = 0;
+
+        while (!pq.empty()) {
+            auto [p, v] = pq.top();
+            pq.pop();
+            if (contracted[v] || p != priority[v]) continue;
+
+            // Recompute the priority, and contract the node only if it is still the smallest one
+            priority[v] = edgeDifference(v);
+            if (!pq.empty() && priority[v] > pq.top().first) {
+                pq.emplace(priority[v], v);
+                continue;
+            }
+
+            numShortcuts += contract(v, false);
+            contracted[v] = true;
+            rank[v] = next++;
+            upward[v] = work[v];
+
+            // Remove the node from its neighbors and update their priorities
+            for (const ChEdge &e : work[v]) {
+                vector<ChEdge> &nbr = work[e.to];
+                auto back = find_if(nbr.begin(), nbr.end(), [v](const ChEdge &f) { return f.to == v; });
+                if (back != nbr.end()) nbr.erase(back);
+                ++deletedNeighbors[e.to];
+                priority[e.to] = edgeDifference(e.to);
+                pq.emplace(priority[e.to], e.to);
+            }
+            vector<ChEdge>().swap(work[v]);
+        }
+
+        // Keep the edges going upwards in the CSR form
+        offset.assign(n + 1, 0);
+        for (ll v = 0; v < n; ++v) {
+            offset[v + 1] = offset[v] + upward[v].size();
+            for (const ChEdge &e : upward[v]) {
+                if (e.weight >= UINT32_MAX) {
+                    std::cout << "Shortcut of weight " << e.weight << " does not fit in the contraction hierarchy\n";
+                    exit(EXIT_FAILURE);
+                }
+                adj.emplace_back(e.to);
+                weight.emplace_back(e.weight);
+                middle.emplace_back(e.middle == -1 ? UINT32_MAX : e.middle);
+            }
+        }
+        return numShortcuts;
+    }
+
+    // Writes the hierarchy along with the names of the nodes to the given file
+    void save(const string &fileName, const NodeTable &nodes) const {
+        ofstream outFile{fileName, ios::out | ios::binary};
+        if (!outFile) {
+            std::cout << "File '" << fileName << "' could not be opened!\n";
+            exit(EXIT_FAILURE);
+        }
+        outFile.write(CH_MAGIC, 8);
+        writeValue(outFile, (uint64_t)numNodes());
+        writeValue(outFile, (uint64_t)nodes.size());
+        for (string_view name : nodes.names) {
+            writeValue(outFile, (uint32_t)name.size());
+            outFile.write(name.data(), name.size());
+        }
+        writeVector(outFile, offset);
+        writeVector(outFile, adj);
+        writeVector(outFile, weight);
+        writeVector(outFile, middle);
+    }
+
+    // Reads the hierarchy along with the names of the nodes from the given file
+    void load(const string &fileName, NodeTable &nodes) {
+        ifstream inFile{fileName, ios::in | ios::binary};
+        if (!inFile) {
+            std::cout << "File '" << fileName << "' could not be opened!\n";
+            exit(EXIT_FAILURE);
+        }
+
+        char magic[8];
+        uint64_t n = 0, numNames = 0;
+        inFile.read(magic, 8);
+        readValue(inFile, n);
+        readValue(inFile, numNames);
+        if (!inFile || string(magic, 8) != CH_MAGIC || numNames > n) {
+            std::cout << "File '" << fileName << "' is not a contraction hierarchy\n";
+            exit(EXIT_FAILURE);
+        }
+        string name;
+        for (uint64_t i = 0; i < numNames && inFile; ++i) {
+            uint32_t len = 0;
+            readValue(inFile, len);
+            name.resize(len);
+            inFile.read(name.data(), len);
+            nodes.intern(name);
+        }
+        readVector(inFile, offset, n + 1);
+
+        // The entries of the nodes follow each other from the first one, so the offsets start at 0 and never decrease
+        bool valid = !inFile || offset[0] == 0;
+        for (uint64_t u = 0; valid && inFile && u < n; ++u) valid = offset[u] <= offset[u + 1];
+        uint64_t numEntries = valid && inFile ? offset[n] : 0;
+        readVector(inFile, adj, numEntries);
+        readVector(inFile, weight, numEntries);
+        readVector(inFile, middle, numEntries);
+
+        // Every entry leads to a node of the hierarchy, and so does the node skipped by a shortcut
+        for (uint64_t j = 0; valid && inFile && j < numEntries; ++j) {
+            valid = adj[j] < n && (middle[j] == UINT32_MAX || middle[j] < n);
+        }
+        if (!valid) {
+            std::cout << "File '" << fileName << "' is not a contraction hierarchy\n";
+            exit(EXIT_FAILURE);
+        }
+        if (!inFile) {
+            std::cout << "File '" << fileName << "' is truncated\n";
+            exit(EXIT_FAILURE);
+        }
+        forward = backward = SearchSpace(n);
+    }
+
+    // Finds the shortest path between the nodes `s` and `t` by searching upwards from both of them
+    // Returns the distance and fills the unpacked path, which is empty if `t` is not reachable from `s`
+    // Also returns the number of nodes settled by the search
+    ll query(ll s, ll t, vector<ll> &path, ll &numSettled) {
+        path.clear();
+        forward.reset(s);
+        forward.push(s, 0);
+        backward.reset(t);
+        backward.push(t, 0);
+
+        // The best distance found so far and the node where the two searches meet on that path
+        ll best = INF, meet = -1;
+
+        // Unlike the plain bidirectional search, both the sides go on till their smallest key reaches the best distance
+        while (true) {
+            bool moreF = !forward.heap.empty() && forward.heap.top().first < best;
+            bool moreB = !backward.heap.empty() && backward.heap.top().first < best;
+            if (!moreF && !moreB) break;
+
+            bool isForward = moreF && (!moreB || forward.heap.top().first <= backward.heap.top().first);
+            SearchSpace &ss = isForward ? forward : backward;
+            const SearchSpace &other = isForward ? backward : forward;
+
+            ll u = ss.heap.pop().second;
+            ss.settle(u);
+            if (other.isReached(u) && ss.distance[u] + other.distance[u] < best) {
+                best = ss.distance[u] + other.distance[u];
+                meet = u;
+            }
+
+            for (uint32_t j = offset[u]; j < offset[u + 1]; ++j) {
+                ll v = adj[j], d = ss.distance[u] + weight[j];
+                ++ss.counters.relaxations;
+                if (d < ss.dist(v)) {
+                    ss.reach(v, d, u);
+                    ss.push(v, d);
+                    ++ss.counters.decreases;
+                }
+            }
+        }
+        numSettled = forward.numSettled + backward.numSettled;
+
+        if (meet == -1) return INF;
+
+        // Unpack the edges of the path from `s` to the meeting node, and from there to `t`
+        vector<ll> up;
+        for (ll v = meet; v != -1; v = forward.parent[v]) up.emplace_back(v);
+        reverse(up.begin(), up.end());
+        for (ll v = backward.parent[meet]; v != -1; v = backward.parent[v]) up.emplace_back(v);
+
+        path.emplace_back(s);
+        for (size_t i = 0; i + 1 < up.size(); ++i) unpack(up[i], up[i + 1], path);
+        return best;
+    }
+
+    // Returns the work done by the witness searches of the contraction and by the searches of the queries
+    SpfCounters counters() const {
+        SpfCounters c = witness.counters;
+        c += forward.counters;
+        c += backward.counters;
+        return c;
+    }
+
+   private:
+    // The working graph, whether every node is contracted and its number of contracted neighbors
+    vector<vector<ChEdge>> work;
+    vector<bool> contracted;
+    vector<ll> deletedNeighbors;
+
+    // The position of every neighbor in the list of the node being contracted, -1 for the other nodes
+    vector<ll> position;
+
+    // The search space of the witness searches, and of both the directions of the queries
+    SearchSpace witness{0}, forward{0}, backward{0};
+
+    // Adds the edge u-v to the working graph, or lowers the weight of the existing one
+    // A loop never lies on a shortest path, so it is left out
+    void addEdge(ll u, ll v, ll w, ll mid) {
+        if (u == v) return;
+        for (ll x : {u, v}) {
+            ll y = x == u ? v : u;
+            auto e = find_if(work[x].begin(), work[x].end(), [y](const ChEdge &f) { return f.to == y; });
+            if (e == work[x].end()) {
+                work[x].push_back(ChEdge{y, w, mid});
+            } else if (w < e->weight) {
+                e->weight = w;
+                e->middle = mid;
+            }
+        }
+    }
+
+    // Returns the priority of contracting the node
+    ll edgeDifference(ll v) {
+        return contract(v, true) - (ll)work[v].size() + deletedNeighbors[v];
+    }
+
+    // Finds the shortcuts needed to contract the node, and adds them unless only simulating
+    // Returns the number of shortcuts needed
+    ll contract(ll v, bool simulate) {
+        ll numShortcuts = 0;
+        vector<ChEdge> &nbrs = work[v];
+        for (size_t k = 0; k < nbrs.size(); ++k) position[nbrs[k].to] = k;
+
+        // The ends and the weight of every shortcut to add
+        vector<array<ll, 3>> shortcuts;
+        for (size_t i = 0; i + 1 < nbrs.size(); ++i) {
+            // Search from every neighbor for witnesses to the neighbors after it, no further than the
+            // longest path to them through the node
+            ll u = nbrs[i].to, maxOut = 0;
+            for (size_t k = i + 1; k < nbrs.size(); ++k) maxOut = max(maxOut, nbrs[k].weight);
+            witnessSearch(u, v, i, nbrs[i].weight + maxOut, simulate ? MAX_WITNESS_SETTLED / 10 : MAX_WITNESS_SETTLED);
+            for (size_t k = i + 1; k < nbrs.size(); ++k) {
+                ll w = nbrs[k].to, viaV = nbrs[i].weight + nbrs[k].weight;
+                if (witness.dist(w) <= viaV) continue;
+                ++numShortcuts;
+                if (!simulate) shortcuts.push_back({u, w, viaV});
+            }
+        }
+
+        for (const ChEdge &e : nbrs) position[e.to] = -1;
+        for (const auto &e : shortcuts) addEdge(e[0], e[1], e[2], v);
+        return numShortcuts;
+    }
+
+    // Runs the Dijkstra algorithm from the `i`th neighbor `u` of the node `v` over the nodes not contracted yet
+    // avoiding `v`, till the neighbors of `v` after `u` are all settled, the distance goes beyond the given limit
+    // or enough nodes are settled
+    void witnessSearch(ll u, ll v, ll i, ll limit, ll maxSettled) {
+        ll numTargets = (ll)work[v].size() - i - 1;
+        witness.reset(u);
+        witness.push(u, 0);
+        while (!witness.heap.empty() && numTargets > 0 && witness.numSettled < maxSettled) {
+            auto [d, x] = witness.heap.pop();
+            if (d > limit) break;
+            witness.settle(x);
+            if (position[x] > i) --numTargets;
+            for (const ChEdge &e : work[x]) {
+                if (e.to == v || contracted[e.to]) continue;
+                ++witness.counters.relaxations;
+                if (d + e.weight < witness.dist(e.to)) {
+                    witness.reach(e.to, d + e.weight, x);
+                    witness.push(e.to, d + e.weight);
+                    ++witness.counters.decreases;
+                }
+            }
+        }
+    }
+
+    // Appends the nodes of the edge a-b after `a` to the path, unpacking the shortcuts recursively
+    void unpack(ll a, ll b, vector<ll> &path) const {
+        // The edge is kept at the end contracted first
+        ll j = findEdge(a, b);
+        if (j == -1) j = findEdge(b, a);
+        if (middle[j] == UINT32_MAX) {
+            path.emplace_back(b);
+            return;
+        }
+        unpack(a, middle[j], path);
+        unpack(middle[j], b, path);
+    }
+
+    // Returns the index of the upward edge from `a` to `b`, or -1 if there is none
+    ll findEdge(ll a, ll b) const {
+        for (uint32_t j = offset[a]; j < offset[a + 1]; ++j) {
+            if (adj[j] == b) return j;
+        }
+        return -1;
+    }
+
+    // Writes the value in its binary form to the stream
+    template <typename T>
+    static void writeValue(ostream &os, const T &value) {
+        os.write((const char *)&value, sizeof(T));
+    }
+
+    // Reads the value in its binary form from the stream
+    template <typename T>
+    static void readValue(istream &is, T &value) {
+        is.read((char *)&value, sizeof(T));
+    }
+
+    // Writes the array in its binary form to the stream
+    static void writeVector(ostream &os, const vector<uint32_t> &v) {
+        os.write((const char *)v.data(), v.size() * sizeof(uint32_t));
+    }
+
+    // Reads `n` entries of the array from the stream
+    static void readVector(istream &is, vector<uint32_t> &v, uint64_t n) {
+        v.resize(is ? n : 0);
+        is.read((char *)v.data(), v.size() * sizeof(uint32_t));
+    }
+};
+
+// Contracts the graph and saves the contraction hierarchy to the given file
+// Adds the work done by the witness searches to the given counters
+void buildHierarchy(const Graph &gr, const NodeTable &nodes, const string &fileName, SpfCounters &counters) {
+    auto start = chrono::steady_clock::now();
+    ContractionHierarchy ch;
+    ll numShortcuts = ch.build(gr);
+    ch.save(fileName, nodes);
+    counters += ch.counters();
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+    std::cout << "Contracted " << gr.numNodes() << " nodes adding " << numShortcuts << " shortcut(s) in "
+              << elapsed.count() << " ms, saved the hierarchy to '" << fileName << "'\n";
+}
+
+// Loads the contraction hierarchy from the given file and answers the point-to-point queries with it
+// Adds the work done by the searches to the given counters
+void queryHierarchy(const string &fileName, const Options &opts, SpfCounters &counters) {
+    NodeTable nodes;
+    ContractionHierarchy ch;
+    ch.load(fileName, nodes);
+    answerQueries(opts.queries, nodes, [&](ll s, ll t, vector<Route> &routes) {
+        Route route;
+        ll numSettled;
+        route.distance = ch.query(s, t, route.path, numSettled);
+        routes.clear();
+        if (route.distance != INF) routes.emplace_back(move(route));
+        return numSettled;
+    });
+    counters += ch.counters();
+}
+
+// Address served when only a port is given
+#define SERVE_DEFAULT_HOST "127.0.0.1"
+
+// Maximum length of a request line, longer lines close the connection
+#define MAX_REQUEST_LENGTH (1 << 16)
+
+// Long-running server answering the routing requests over the graph loaded once
+// Clients send one request per line and get back `OK <n>` followed by `n` lines, or `ERR <message>`:
+//   route <src>            the routing table of the source node, as printed for a single source node
+//   route <src> <dst>      the row of the destination node in that table
+//   update <u> <v> <w>     sets the weight of the link between the nodes
+//   stats                  the number of cache hits and misses, and the number of cached trees
+// The shortest path trees of the recently routed source nodes are kept in an LRU cache, so repeated requests
+// only walk the cached parents. All the cached trees are dropped when a link changes
+// The clients are served one request at a time by a single thread polling all the sockets
+// SIGINT or SIGTERM stops the server, which closes the connections and returns to let the stats be written
+class RouteServer {
+   public:
+    // Constructor
+    RouteServer(Graph &gr, const NodeTable &nodes, const Options &opts)
+        : gr{gr}, nodes{nodes}, opts{opts}, scratch(opts.arity), numHits{0}, numMisses{0} {}
+
+    // Listens on the given address, `unix:<path>` or `[<host>:]<port>`, and serves the clients till SIGINT or SIGTERM
+    void run(const string &address) {
+        int listenFd = listenOn(address);
+        std::cout << "Serving " << gr.numNodes() << " nodes on " << address << endl;
+
+        // The stopping signals are blocked except while polling, so one arriving between the check of the flag
+        // and the poll still interrupts it
+        struct sigaction action{}, oldInt, oldTerm;
+        action.sa_handler = stop;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, &oldInt);
+        sigaction(SIGTERM, &action, &oldTerm);
+        sigset_t blocked, pollMask;
+        sigemptyset(&blocked);
+        sigaddset(&blocked, SIGINT);
+        sigaddset(&blocked, SIGTERM);
+        sigprocmask(SIG_BLOCK, &blocked, &pollMask);
+        sigdelset(&pollMask, SIGINT);
+        sigdelset(&pollMask, SIGTERM);
+        stopping = 0;
+
+        // The listening socket comes first, followed by the sockets of the clients
+        vector<pollfd> fds{pollfd{listenFd, POLLIN, 0}};
+        vector<Client> clients;
+        while (!stopping) {
+            for (size_t i = 0; i < clients.size(); ++i) {
+                fds[i + 1].events = POLLIN | (clients[i].out.empty() ? 0 : POLLOUT);
+            }
+            if (ppoll(fds.data(), fds.size(), nullptr, &pollMask) == -1) {
+                if (errno == EINTR) continue;
+                std::cout << "Polling the sockets failed: " << strerror(errno) << "\n";
+                exit(EXIT_FAILURE);
+            }
+
+            // Serve the clients with pending input or output, closing the connections which ended or failed
+            for (size_t i = 0; i < clients.size();) {
+                bool open = true;
+                if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) open = receive(clients[i]);
+                if (open && !clients[i].out.empty()) open = flush(clients[i]);
+                if (open) {
+                    ++i;
+                    continue;
+                }
+                close(clients[i].fd);
+                clients.erase(clients.begin() + i);
+                fds.erase(fds.begin() + i + 1);
+            }
+
+            // Accept the new clients
+            if (fds[0].revents & POLLIN) {
+                int fd = accept(listenFd, nullptr, nullptr);
+                if (fd == -1) continue;
+                fcntl(fd, F_SETFL, O_NONBLOCK);
+                clients.push_back(Client{fd, "", ""});
+                fds.push_back(pollfd{fd, POLLIN, 0});
+            }
+        }
+
+        // Close the connections and the listening socket, removing the one of a Unix domain address
+        for (Client &client : clients) close(client.fd);
+        close(listenFd);
+        if (address.rfind("unix:", 0) == 0) unlink(address.substr(5).c_str());
+        sigaction(SIGINT, &oldInt, nullptr);
+        sigaction(SIGTERM, &oldTerm, nullptr);
+        sigprocmask(SIG_UNBLOCK, &blocked, nullptr);
+        std::cout << "Stopped serving on " << address << endl;
+    }
+
+    // Executes a single request line and returns the response
+    string execute(const string &line) {
+        istringstream in(line);
+        string cmd, a, b, c, extra;
+        in >> cmd >> a >> b >> c >> extra;
+        if (!extra.empty()) return "ERR Too many arguments\n";
+
+        if (cmd == "route" && !a.empty() && c.empty()) {
+            ll src = nodes.find(a), dst = b.empty() ? -1 : nodes.find(b);
+            if (src == -1 || (!b.empty() && dst == -1)) {
+                return "ERR Node '" + (src == -1 ? a : b) + "' is not present in the network\n";
+            }
+            const CachedTree &t = tree(src);
+            ostringstream os;
+            if (b.empty()) {
+                printResults(src, t.distance, t.parent, nodes, os);
+            } else {
+                OutputBuffer out(os);
+                printRow(dst, t.distance, t.parent, nodes, out);
+            }
+            return respond(os.str());
+        }
+
+        if (cmd == "update" && !c.empty()) {
+            ll u = nodes.find(a), v = nodes.find(b), w;
+            try {
+                // For this question weight should be a positive integer
+                // less than 10000
+                w = stringToLong(c);
+                if (w <= 0 || w >= MAX_EDGE_WEIGHT) throw exception();
+            } catch (exception &e) {
+                return "ERR The weight of a link should be a positive integer less than 10,000, but got '" + c + "'\n";
+            }
+            if (u == -1 || v == -1 || setLinkWeight(gr, u, v, w) == INF) {
+                return "ERR There is no link between the nodes '" + a + "' and '" + b + "' in the network\n";
+            }
+
+            // Every cached tree may have changed
+            cache.clear();
+            cacheIndex.clear();
+            return respond("");
+        }
+
+        if (cmd == "stats" && a.empty()) {
+            ostringstream os;
+            os << "hits " << numHits << " misses " << numMisses << " cached " << cache.size() << "\n";
+            return respond(os.str());
+        }
+
+        return "ERR Unknown request, expected 'route <src> [<dst>]', 'update <u> <v> <w>' or 'stats'\n";
+    }
+
+    // Returns the work done by the runs of the Dijkstra algorithm for the trees missing from the cache
+    SpfCounters counters() const {
+        return scratch.counters;
+    }
+
+   private:
+    // A connected client, with the bytes received but not executed yet and the bytes not sent yet
+    class Client {
+       public:
+        int fd;
+        string in, out;
+    };
+
+    // The shortest path tree of a source node
+    class CachedTree {
+       public:
+        ll source;
+        vector<ll> distance, parent;
+    };
+
+    // The graph, the names of its nodes and the options of the Dijkstra algorithm
+    Graph &gr;
+    const NodeTable &nodes;
+    const Options &opts;
+    SpfScratch scratch;
+
+    // The cached trees from the most recently used one, and the position of the tree of every cached source node
+    list<CachedTree> cache;
+    unordered_map<ll, list<CachedTree>::iterator> cacheIndex;
+    ll numHits, numMisses;
+
+    // Returns the shortest path tree of the source node, computing it if it is not cached
+    const CachedTree &tree(ll source) {
+        auto it = cacheIndex.find(source);
+        if (it != cacheIndex.end()) {
+            // Move the tree to the front of the cache
+            ++numHits;
+            cache.splice(cache.begin(), cache, it->second);
+            return cache.front();
+        }
+
+        ++numMisses;
+        dijkstra(source, gr, opts, scratch);
+
+        // Evict the least recently used tree, reusing its buffers
+        if ((ll)cache.size() >= opts.cacheTrees) {
+            cacheIndex.erase(cache.back().source);
+            cache.splice(cache.begin(), cache, prev(cache.end()));
+        } else {
+            cache.emplace_front();
+        }
+        CachedTree &t = cache.front();
+        t.source = source;
+        t.distance.swap(scratch.distance);
+        t.parent.swap(scratch.parent);
+        cacheIndex[source] = cache.begin();
+        return t;
+    }
+
+    // Frames the response body as `OK <number of lines>` followed by the lines
+    static string respond(const string &body) {
+        return "OK " + to_string(count(body.begin(), body.end(), '\n')) + "\n" + body;
+    }
+
+    // Reads the available input of the client and executes its complete request lines
+    // Returns false if the connection ended or failed
+    bool receive(Client &client) {
+        char buf[1 << 12];
+        ssize_t n = recv(client.fd, buf, sizeof(buf), 0);
+        if (n == 0 || (n == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) return false;
+        if (n > 0) client.in.append(buf, n);
+
+        size_t start = 0, eol;
+        while ((eol = client.in.find('\n', start)) != string::npos) {
+            client.out += execute(client.in.substr(start, eol - start));
+            start = eol + 1;
+        }
+        client.in.erase(0, start);
+        return client.in.size() <= MAX_REQUEST_LENGTH;
+    }
+
+    // Sends as much of the pending output of the client as the socket takes
+    // Returns false if the connection failed
+    static bool flush(Client &client) {
+        ssize_t n = send(client.fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+        if (n == -1) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        client.out.erase(0, n);
+        return true;
+    }
+
+    // Set by SIGINT or SIGTERM to stop the server
+    inline static volatile sig_atomic_t stopping = 0;
+
+    // Handles the stopping signals
+    static void stop(int) { stopping = 1; }
+
+    // Creates the socket listening on the given address
+    static int listenOn(const string &address) {
+        int fd = -1;
+        bool bound = false;
+        if (address.rfind("unix:", 0) == 0) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            string path = address.substr(5);
+            if (!path.empty() && path.size() < sizeof(addr.sun_path)) {
+                // Remove the socket left behind by an earlier server
+                unlink(path.c_str());
+                copy(path.begin(), path.end(), addr.sun_path);
+                fd = socket(AF_UNIX, SOCK_STREAM, 0);
+                bound = fd != -1 && bind(fd, (sockaddr *)&addr, sizeof(addr)) == 0;
+            }
+        } else {
+            size_t colon = address.rfind(':');
+            string host = colon == string::npos ? SERVE_DEFAULT_HOST : address.substr(0, colon);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            ll port = -1;
+            try {
+                port = stringToLong(address.substr(colon == string::npos ? 0 : colon + 1));
+            } catch (exception &e) {
+            }
+            if (port > 0 && port < 65536 && inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1) {
+                addr.sin_port = htons(port);
+                fd = socket(AF_INET, SOCK_STREAM, 0);
+                int one = 1;
+                if (fd != -1) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+                bound = fd != -1 && bind(fd, (sockaddr *)&addr, sizeof(addr)) == 0;
+            }
+        }
+
+        if (!bound || listen(fd, SOMAXCONN) != 0) {
+            std::cout << "Could not listen on '" << address << "', expected unix:<path> or [<host>:]<port>\n";
+            exit(EXIT_FAILURE);
+        }
+        return fd;
+    }
+};
+
+// Writes the time of every phase, the peak resident memory and the counters of the shortest path kernels
+// as a single JSON object to the file given with --stats, or to the standard error
+void writeStats(const Options &opts, const PhaseTimer &timer, const SpfCounters &counters) {
+    ofstream outFile;
+    if (opts.statsFile != "-") {
+        outFile.open(opts.statsFile, ios::out | ios::trunc);
+        if (!outFile) {
+            std::cout << "File '" << opts.statsFile << "' could not be opened for writing!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    ostream &os = opts.statsFile == "-" ? std::cerr : outFile;
+
+    // The peak resident set size of the process, in kilobytes on Linux
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    os << "{\"program\": \"Q1\", ";
+    timer.json(os);
+    os << ", \"peak_rss_kb\": " << usage.ru_maxrss << ", \"counters\": {\"relaxations\": " << counters.relaxations
+       << ", \"decreases\": " << counters.decreases << ", \"pushes\": " << counters.pushes << ", \"pops\": " << counters.pops << "}}\n";
+}
+
+// Separates the `--name=value` options from the positional arguments of the command line
+// and fills the options. Exits with failure status on an unknown or invalid option
+void parseOptions(int argc, char const *argv[], Options &opts, vector<string> &args) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        // Every argument not starting with `--` is a positional argument
+        if (arg.rfind("--", 0) != 0) {
+            args.emplace_back(arg);
+            continue;
+        }
+
+        // Split the option into its name and value
+        size_t eq = arg.find('=');
+        string name = arg.substr(2, eq == string::npos ? string::npos : eq - 2);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+        if (name == "queue" && value == "linear") {
+            opts.queue = QueueType::LINEAR;
+        } else if (name == "queue" && value == "heap") {
+            opts.queue = QueueType::HEAP;
+        } else if (name == "queue" && value == "dial") {
+            opts.queue = QueueType::DIAL;
+        } else if (name == "kernel" && value == "dijkstra") {
+            opts.kernel = SpfKernel::DIJKSTRA;
+        } else if (name == "kernel" && value == "delta") {
+            opts.kernel = SpfKernel::DELTA;
+        } else if (name == "delta") {
+            try {
+                opts.delta = stringToLong(value);
+                if (opts.delta <= 0) throw exception();
+            } catch (exception &e) {
+                std::cout << "Bucket width of the delta-stepping kernel should be a positive integer, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (name == "arity") {
+            try {
+                opts.arity = stringToLong(value);
+                if (opts.arity < 2) throw exception();
+            } catch (exception &e) {
+                std::cout << "Arity of the heap should be an integer greater than 1, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (name == "all-sources" && value.empty()) {
+            opts.allSources = true;
+        } else if (name == "ecmp" && value.empty()) {
+            opts.ecmp = true;
+        } else if (name == "output" && value == "paths") {
+            opts.output = OutputFormat::PATHS;
+        } else if (name == "output" && value == "csv") {
+            opts.output = OutputFormat::CSV;
+        } else if (name == "output" && value == "binary") {
+            opts.output = OutputFormat::BINARY;
+        } else if (name == "updates" && !value.empty()) {
+            opts.updates = value;
+        } else if (name == "queries" && !value.empty()) {
+            opts.queries = value;
+        } else if (name == "query-algo" && value == "full") {
+            opts.queryAlgo = QueryAlgo::FULL;
+        } else if (name == "query-algo" && value == "bidir") {
+            opts.queryAlgo = QueryAlgo::BIDIR;
+        } else if (name == "query-algo" && value == "alt") {
+            opts.queryAlgo = QueryAlgo::ALT;
+        } else if (name == "landmarks") {
+            try {
+                opts.landmarks = stringToLong(value);
+                if (opts.landmarks < 0) throw exception();
+            } catch (exception &e) {
+                std::cout << "Number of landmarks should be a non-negative integer, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (name == "k-paths") {
+            try {
+                opts.kPaths = stringToLong(value);
+                if (opts.kPaths <= 0) throw exception();
+            } catch (exception &e) {
+                std::cout << "Number of paths per query should be a positive integer, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (name == "ch-build" && !value.empty()) {
+            opts.chBuild = value;
+        } else if (name == "ch" && !value.empty()) {
+            opts.ch = value;
+        } else if (name == "serve" && !value.empty()) {
+            opts.serve = value;
+        } else if (name == "cache") {
+            try {
+                opts.cacheTrees = stringToLong(value);
+                if (opts.cacheTrees <= 0) throw exception();
+            } catch (exception &e) {
+                std::cout << "Number of cached trees should be a positive integer, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (name == "timing" && value.empty()) {
+            opts.timing = true;
+        } else if (name == "stats") {
+            opts.stats = true;
+            if (!value.empty()) opts.statsFile = value;
+        } else if (name == "save-snapshot" && !value.empty()) {
+            opts.saveSnapshot = value;
+        } else if (name == "verify-snapshot" && value.empty()) {
+            opts.verifySnapshot = true;
+        } else if (name == "semi-external" && value.empty()) {
+            opts.semiExternal = true;
+        } else if (name == "threads") {
+            try {
+                opts.threads = stringToLong(value);
+                if (opts.threads <= 0) throw exception();
+            } catch (exception &e) {
+                std::cout << "Number of threads should be a positive integer, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            std::cout << "Unknown option '" << arg << "'\n";
+            std::cout << "Supported options are: --queue=linear|heap|dial --arity=<d> --kernel=dijkstra|delta --delta=<w> --threads=<n> --all-sources --ecmp --output=paths|csv|binary --updates=<file> --queries=<file> --query-algo=full|bidir|alt --landmarks=<k> --k-paths=<k> --ch-build=<file> --ch=<file> --save-snapshot=<file> --verify-snapshot --semi-external --timing --stats[=<file>] --serve=unix:<path>|[<host>:]<port> --cache=<k>\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    // Timing the phases of the run from the start
+    PhaseTimer timer;
+
+    // Separating the options from the arguments
+    Options opts;
+    vector<string> args;
+    parseOptions(argc, argv, opts, args);
+
+    // The paths beyond the least cost one are only found by the queries over the graph
+    if (opts.kPaths > 1 && (opts.queries.empty() || !opts.ch.empty())) {
+        std::cout << "More than one path per query is only supported with --queries=<file> over the graph";
+        return EXIT_FAILURE;
+    }
+
+    // The contraction hierarchy has everything needed to answer the queries
+    if (!opts.ch.empty()) {
+        if (!args.empty() || opts.queries.empty()) {
+            std::cout << "Please provide the arguments as follows: ./<prog_name.out> --ch=<file> --queries=<file>";
+            return EXIT_FAILURE;
+        }
+        SpfCounters counters;
+        queryHierarchy(opts.ch, opts, counters);
+        timer.lap("ch-queries");
+        if (opts.timing) timer.report(std::cerr);
+        if (opts.stats) writeStats(opts, timer, counters);
+        return EXIT_SUCCESS;
+    }
+
+    // This program requires three arguments from the command line, the source node is not needed
+    // for all the sources, for the point-to-point queries, for building the contraction hierarchy or for serving
+    size_t expArgs = opts.allSources || !opts.queries.empty() || !opts.chBuild.empty() || !opts.serve.empty() ? 2 : 3;
+    if (args.size() != expArgs) {
+        std::cout << "Expected " << expArgs << " arguments, but received " << args.size() << "\n";
+        std::cout << "Please provide the arguments as follows: ./<prog_name.out> [--queue=linear|heap|dial] [--arity=<d>] [--kernel=dijkstra|delta] [--delta=<w>] [--threads=<n>] [--ecmp] [--output=paths|csv|binary] [--updates=<file>] <numNodes> <sourceNode> <fileName>\n";
+        std::cout << "or for the routing tables of all the nodes: ./<prog_name.out> --all-sources [options] <numNodes> <fileName>\n";
+        std::cout << "or for the point-to-point queries: ./<prog_name.out> --queries=<file> [--k-paths=<k>] [options] <numNodes> <fileName>\n";
+        std::cout << "or for building the contraction hierarchy: ./<prog_name.out> --ch-build=<file> [options] <numNodes> <fileName>\n";
+        std::cout << "or for serving the routing requests: ./<prog_name.out> --serve=unix:<path>|[<host>:]<port> [options] <numNodes> <fileName>\n";
+        std::cout << "where <fileName> is a text file of edges, built on the disk with --semi-external, or a snapshot saved with --save-snapshot=<file>";
+        return EXIT_FAILURE;
+    }
+
+    // Getting the number of nodes in the network
+    ll numNodes;
+    try {
+        numNodes = stringToLong(args[0]);
+        if (numNodes <= 0) throw exception();
+    } catch (exception &e) {
+        std::cout << "Number of nodes should be provided as a positive integer, got '" << args[0] << "'\n";
+        return EXIT_FAILURE;
+    }
+
+    string fileName = args.back();  // The filename containing edges information
+
+    // Reading the graph from the edges or the snapshot in the file
+    // The graph is declared first, as the names of the nodes may be views into its snapshot
+    Graph graph;
+    NodeTable nodes;
+    loadGraph(numNodes, fileName, opts, nodes, graph, timer);
+
+    // The work done by the shortest path kernels of the run
+    SpfCounters counters;
+
+    if (opts.allSources) {
+        // Computing and printing the routing tables of all the nodes
+        allSources(graph, nodes, opts, counters);
+        timer.lap("all-sources");
+    } else if (!opts.serve.empty()) {
+        // Serving the routing requests till the server is stopped with SIGINT or SIGTERM
+        RouteServer server(graph, nodes, opts);
+        server.run(opts.serve);
+        counters = server.counters();
+        timer.lap("serve");
+    } else if (!opts.chBuild.empty()) {
+        // Building and saving the contraction hierarchy
+        buildHierarchy(graph, nodes, opts.chBuild, counters);
+        timer.lap("ch-build");
+    } else if (!opts.queries.empty()) {
+        // Answering the point-to-point queries
+        runQueries(graph, nodes, opts, counters);
+        timer.lap("queries");
+    } else {
+        // The source node, which is not part of the network if it does not appear in the file
+        string sourceNode = args[1];
+        ll sNode = nodes.intern(sourceNode);
+        if (nodes.size() > numNodes) {
+            std::cout << "Number of distinct nodes in the input file is greater than the given number of nodes\n";
+            return EXIT_FAILURE;
+        }
+
+        // Executing the dijkstra algorithm
+        SpfScratch scratch(opts.arity);
+        dijkstra(sNode, graph, opts, scratch);
+        timer.lap("route");
+
+        // Printing the results obtained, with all the equal-cost paths or only the next hops if asked for
+        if (opts.ecmp) {
+            equalCostDag(graph, scratch);
+            printEcmpResults(sNode, scratch, nodes, std::cout);
+        } else if (opts.output == OutputFormat::PATHS) {
+            printResults(sNode, scratch.distance, scratch.parent, nodes, std::cout);
+        } else {
+            if (opts.output == OutputFormat::CSV) std::cout << "source,destination,distance,next_hop\n";
+            writeNextHops(sNode, scratch.distance, scratch.parent, nodes, opts.output, std::cout);
+        }
+        std::cout.flush();
+        timer.lap("print");
+
+        // Applying the link cost updates to the shortest path tree
+        if (!opts.updates.empty()) {
+            dynamicSpf(sNode, graph, nodes, scratch, opts.updates);
+            timer.lap("updates");
+        }
+
+        // The repairs of the updates count along with the run which built the tree
+        counters = scratch.counters;
+    }
 
-    // Printing the results obtained
-    printResults(sNode, distance, parent, intToNode);
+    // Reporting the time taken by every phase
+    if (opts.timing) timer.report(std::cerr);
+    if (opts.stats) writeStats(opts, timer, counters);
 
     return EXIT_SUCCESS;
 }
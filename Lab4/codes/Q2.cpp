@@ -1,9 +1,36 @@
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
-#include <map>
+#include <memory>
+#include <numeric>
+#include <queue>
 #include <random>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 using namespace std;
@@ -18,6 +45,102 @@ using ll = long long;
 // INFINITY
 const ll INF = 1e18;
 
+// INFINITY of the 32-bit distances kept in the distance vectors
+#define DV_INF UINT32_MAX
+
+// Number of 32-bit entries every row of the dense distance vectors is padded to, a whole cache line
+#define DV_ROW_ALIGN 16
+
+// Number of nodes whose distance vectors are updated at once by a thread in a synchronous round
+#define DV_SYNC_BLOCK_SIZE 64
+
+// Number of bytes of the header of a triggered update (sender and number of entries) and of every entry in it
+// (destination and distance), used to size the traffic of the link events
+#define DV_UPDATE_HEADER_BYTES 8
+#define DV_UPDATE_ENTRY_BYTES 8
+
+// The ways the nodes can exchange their distance vectors till convergence
+enum class RoutingMode {
+    RANDOM,  // Sweeps over the nodes in random order, every node learning from a random neighbor
+    SYNC,    // Synchronous rounds, every node learning from all its neighbors
+    EVENTS,  // Every node whose vector changed advertises it to all its neighbors through a work queue
+    FLOYD,   // No exchange, the routes of all the pairs are computed at once by the blocked Floyd-Warshall algorithm
+    EMULATE, // Every node owns a UDP socket on the loopback and sends its triggered updates to its neighbors over it
+    AREAS    // The nodes are split into areas, keeping full vectors within their area and one route to every other area
+};
+
+// Largest number of source nodes whose shortest routes are compared with the routes between the areas
+#define AREA_STRETCH_SOURCES 1000
+
+// Number of 32-bit words of the header of an emulated advertisement (sender, link entry at the receiver and number
+// of entries), and largest number of entries in one, so that an advertisement fits a UDP datagram easily
+#define EMU_HEADER_WORDS 3
+#define EMU_MAX_ENTRIES 1024
+
+// Number of datagrams received or sent by one system call of the emulation
+#define EMU_BATCH_SIZE 64
+
+// Size of the receive buffer asked for the socket of every emulated node
+#define EMU_RECEIVE_BUFFER (1 << 20)
+
+// Number of nodes of the side of the tiles of the blocked Floyd-Warshall algorithm, a multiple of DV_ROW_ALIGN
+// The three tiles taken by an update fit in the cache together
+#define FW_TILE_SIZE 64
+
+// The kernels that can update a row of the dense distance vectors from the row of a neighbor
+enum class RowKernel {
+    AUTO,    // The widest kernel supported by the processor
+    SCALAR,  // One entry at a time
+    SSE4,    // Four entries at a time with SSE4.1 instructions
+    AVX2     // Eight entries at a time with AVX2 instructions
+};
+
+// Command line options of the program, given as `--name=value` anywhere among the arguments
+class Options {
+   public:
+    // The number of threads to use, all the hardware threads by default
+    ll threads = max(1U, thread::hardware_concurrency());
+
+    // The file to save the snapshot of the graph to, and whether to verify the snapshots being loaded
+    string saveSnapshot;
+    bool verifySnapshot = false;
+
+    // Whether to print the time taken by every phase of the run to the standard error
+    bool timing = false;
+
+    // Whether to report the phase times, the peak memory and the updates of every iteration as JSON, and the file
+    // to write them to ("-" for the standard error)
+    bool stats = false;
+    string statsFile = "-";
+
+    // Whether every node keeps only its reachable destinations instead of a full row of the dense matrices
+    bool sparse = false;
+
+    // The kernel updating the rows of the dense distance vectors
+    RowKernel rowKernel = RowKernel::AUTO;
+
+    // The way the nodes exchange their distance vectors
+    RoutingMode mode = RoutingMode::RANDOM;
+
+    // The number of areas the nodes are split into by the area routing
+    ll areas = 0;
+
+    // The seed of the random routing, a new one from the system for every run unless given
+    bool seeded = false;
+    uint32_t seed = 0;
+
+    // Whether to compare the routes of the Floyd-Warshall algorithm with the ones of the distance vector routing
+    bool crossCheck = false;
+
+    // The number of runs of the random routing with consecutive seeds whose convergence is studied, 0 for a single run
+    ll runs = 0;
+
+    // The file of the link events applied after the convergence, and whether the triggered updates
+    // omit (split horizon) or poison (poison reverse) the routes through the neighbor they are sent to
+    string scenario;
+    bool splitHorizon = false, poisonReverse = false;
+};
+
 // Overloading stream insertion operator for generic pairs
 template <typename T1, typename T2>
 ostream &operator<<(ostream &os, const pair<T1, T2> &p) {
@@ -29,17 +152,6 @@ ostream &operator<<(ostream &os, const pair<T1, T2> &p) {
     return os;
 }
 
-// Represents an edge of the network
-class Edge {
-   public:
-    // The vertices `u` and `v` of an edge and the weight `w` of that edge
-    string u, v;
-    ll w;
-
-    // Constructor
-    Edge(string u, string v, ll w) : u{u}, v{v}, w{w} {}
-};
-
 // Takes a string as input and convert it to a long long integer
 // If the string contains non-digit characters, it will throw error
 ll stringToLong(const string &s) {
@@ -56,257 +168,2486 @@ ll stringToLong(const string &s) {
     return isNeg ? -ans : ans;
 }
 
-// Reads input edges from the given filename
-// and fills it inside the input vector of edges
-void readEdges(string fileName, vector<Edge> &edges) {
-    // The `ifstream` object to read an input file
-    ifstream inFile{fileName, ios::in};
+// Calls `fn(i, t)` for every `i` from 0 to `n - 1` using up to `numThreads` threads, `t` being the index
+// of the calling thread. The indices are handed out one at a time, so the threads stay busy even if
+// the calls take uneven time
+template <typename Function>
+void parallelFor(ll n, ll numThreads, Function fn) {
+    atomic<ll> next{0};
+    auto worker = [&](ll t) {
+        for (ll i = next++; i < n; i = next++) fn(i, t);
+    };
 
-    // If the file was not able to open, exit with failure status
-    if (!inFile) {
-        std::cout << "File '" << fileName << "' could not be opened!\n";
-        exit(EXIT_FAILURE);
+    // The calling thread works as well
+    vector<thread> pool;
+    for (ll t = 1; t < min(n, numThreads); ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (thread &th : pool) th.join();
+}
+
+// Wall clock times of the phases of a run, printed to the standard error with `--timing`
+class PhaseTimer {
+   public:
+    // The name of every phase ended so far and its time in microseconds
+    vector<pair<string, ll>> phases;
+
+    // Constructor, the first phase starts now
+    PhaseTimer() : last{chrono::steady_clock::now()} {}
+
+    // Ends the current phase with the given name, the next phase starting now
+    void lap(const string &name) {
+        auto now = chrono::steady_clock::now();
+        phases.emplace_back(name, chrono::duration_cast<chrono::microseconds>(now - last).count());
+        last = now;
     }
 
-    // The vertices and weight of an edge
-    string u, v, w;
-    ll wl;
-    // Read from the file till we are able to read the input
-    while (inFile >> u >> v >> w) {
-        try {
-            // Try converting weight to long long integer
-            wl = stringToLong(w);
-
-            // For this question weight should be a positive integer
-            // less than 10000
-            if (wl <= 0 || wl >= MAX_EDGE_WEIGHT) throw exception();
-        } catch (exception &e) {
-            std::cout << "The weight of an edge between two nodes should be a positive integer less than 10,000, but got '" << w << "'\n";
-            inFile.close();  // Close the file
-            exit(EXIT_FAILURE);
+    // Prints the time of every phase to the given stream
+    void report(ostream &os) const {
+        for (const auto &[name, us] : phases) os << "Phase " << name << ": " << us << " us\n";
+    }
+
+    // Prints the time of every phase as the members of a JSON object, followed by their total
+    void json(ostream &os) const {
+        ll total = 0;
+        os << "\"phases_us\": {";
+        for (size_t i = 0; i < phases.size(); ++i) {
+            os << (i == 0 ? "" : ", ") << "\"" << phases[i].first << "\": " << phases[i].second;
+            total += phases[i].second;
         }
+        os << "}, \"total_us\": " << total;
+    }
 
-        // Create and push the edge into the vector
-        edges.push_back(Edge(u, v, wl));
+   private:
+    // The time at which the current phase started
+    chrono::steady_clock::time_point last;
+};
+
+// Size of every block of the arena holding the node names
+#define NAME_BLOCK_SIZE (1 << 20)
+
+// Interning table assigning consecutive integers starting from 0 to the names of the nodes
+// Every distinct name is copied once into an arena of large character blocks, so no name needs
+// its own heap allocation. Names are looked up in an open-addressing hash table with linear probing,
+// and the reverse direction is a flat vector of views into the arena
+class NodeTable {
+   public:
+    // The name of every node, indexed by the integer assigned to it
+    vector<string_view> names;
+
+    // Constructor, the names are copied into the arena of the table unless `copyNames` is false
+    // in which case the viewed names must outlive the table
+    NodeTable(bool copyNames = true) : slots(16, EMPTY_SLOT), blockUsed{NAME_BLOCK_SIZE}, copyNames{copyNames} {}
+
+    // The number of names present in the table
+    ll size() const {
+        return names.size();
     }
 
-    // Close the input file
-    inFile.close();
-}
+    // Returns the name of the node `i`, or "-" if no name was assigned to it
+    string_view name(ll i) const {
+        return i < (ll)names.size() ? names[i] : "-";
+    }
 
-// Builds a graph from the given set of edges
-// Maps the string name of each node to normalized integer numbers starting from 0
-// and maintains a reverse map of the above. Returns the integer assigned to the source node
-// also initializes the distance vector of each input node
-void buildGraph(ll numNodes, const vector<Edge> &edges, map<string, ll> &nti, map<ll, string> &itn, vector<vector<pair<ll, ll>>> &gr, vector<vector<pair<ll, ll>>> &dv) {
-    ll num = 0;  // The integer assigned to each string name of the node
+    // Returns the integer assigned to the given name, or -1 if it is not present in the table
+    ll find(string_view name) const {
+        uint64_t h = hash(name);
+        for (size_t i = h & (slots.size() - 1);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i] == EMPTY_SLOT) return -1;
+            if (matches(slots[i], h, name)) return (uint32_t)slots[i];
+        }
+    }
+
+    // Returns the integer assigned to the given name, assigning it the next integer if it is not present
+    ll intern(string_view name) {
+        return insert(name, copyNames);
+    }
 
-    // Initialize the adjacency list for each node in the graph
-    gr.assign(numNodes, vector<pair<ll, ll>>());
+    // Same as `intern`, but the name is never copied, so the viewed name must outlive the table
+    ll internView(string_view name) {
+        return insert(name, false);
+    }
+
+    // Grows the hash table ahead of interning the given number of names
+    void reserve(ll numNames) {
+        while (2 * numNames > (ll)slots.size()) grow();
+    }
 
-    // Initialize the distance vector for each node with distance as INFINITY and neighbor as -1
-    dv.assign(numNodes, vector<pair<ll, ll>>(numNodes, make_pair(INF, -1)));
+   private:
+    // Every slot keeps the upper 32 bits of the hash of the name along with the integer assigned to it
+    static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+    static constexpr uint64_t HASH_MASK = 0xffffffff00000000ULL;
 
-    // Loop over all the edges
-    for (const Edge &e : edges) {
-        ll ui, vi;                  // The integers for both the vertices of the edge
-        auto uItr = nti.find(e.u);  // Try finding the string name in the map
-        if (uItr != nti.end()) {
-            // If it already exists, take that integer
-            ui = uItr->second;
-        } else {
-            // Else assign it a new integer and update the map
-            ui = num++;
-            nti[e.u] = ui;
-            itn[ui] = e.u;
+    // The hash table of the names
+    vector<uint64_t> slots;
+
+    // The blocks of the arena and the number of characters used in the last block
+    vector<unique_ptr<char[]>> blocks;
+    size_t blockUsed;
+
+    // Whether the names are copied into the arena or only viewed
+    bool copyNames;
+
+    // FNV-1a hash of the given name
+    static uint64_t hash(string_view name) {
+        uint64_t h = 14695981039346656037ULL;
+        for (char c : name) {
+            h ^= (unsigned char)c;
+            h *= 1099511628211ULL;
         }
+        return h;
+    }
 
-        auto vItr = nti.find(e.v);  // Try finding the string name in the map
-        if (vItr != nti.end()) {
-            // If it already exists, take that integer
-            vi = vItr->second;
-        } else {
-            // Else assign it a new integer and update the map
-            vi = num++;
-            nti[e.v] = vi;
-            itn[vi] = e.v;
+    // Whether the given slot holds the given name having the given hash
+    bool matches(uint64_t slot, uint64_t h, string_view name) const {
+        return (slot & HASH_MASK) == (h & HASH_MASK) && names[(uint32_t)slot] == name;
+    }
+
+    // Returns the integer assigned to the given name, assigning it the next integer if it is not present
+    // The name of a new node is copied into the arena if `copy` is true
+    ll insert(string_view name, bool copy) {
+        // Keep the load factor of the hash table below one half
+        if (2 * (names.size() + 1) > slots.size()) grow();
+
+        uint64_t h = hash(name);
+        size_t i = h & (slots.size() - 1);
+        for (; slots[i] != EMPTY_SLOT; i = (i + 1) & (slots.size() - 1)) {
+            if (matches(slots[i], h, name)) return (uint32_t)slots[i];
         }
 
-        // The provided input number of nodes and number of distinct nodes found in the
-        // input file should be same
-        if (num > numNodes) {
-            std::cout << "Number of distinct nodes in the input file is greater than the given number of nodes\n";
-            exit(EXIT_FAILURE);
+        // Copy the name into the arena and assign it the next integer
+        ll id = names.size();
+        names.emplace_back(copy ? store(name) : name);
+        slots[i] = (h & HASH_MASK) | id;
+        return id;
+    }
+
+    // Doubles the size of the hash table and re-inserts all the names
+    void grow() {
+        vector<uint64_t> old(2 * slots.size(), EMPTY_SLOT);
+        old.swap(slots);
+        for (uint64_t slot : old) {
+            if (slot == EMPTY_SLOT) continue;
+            size_t i = hash(names[(uint32_t)slot]) & (slots.size() - 1);
+            while (slots[i] != EMPTY_SLOT) i = (i + 1) & (slots.size() - 1);
+            slots[i] = slot;
+        }
+    }
+
+    // Copies the given name into the arena and returns the view of the copy
+    string_view store(string_view name) {
+        if (blockUsed + name.size() > NAME_BLOCK_SIZE) {
+            // Start a new block, names longer than a block get a block of their own
+            blocks.emplace_back(new char[max((size_t)NAME_BLOCK_SIZE, name.size())]);
+            blockUsed = 0;
         }
+        char *dst = blocks.back().get() + blockUsed;
+        copy(name.begin(), name.end(), dst);
+        blockUsed += name.size();
+        return string_view(dst, name.size());
+    }
+};
 
-        // Push the edge into the adjacency list of both the vertices
-        gr[ui].emplace_back(make_pair(vi, e.w));
-        gr[vi].emplace_back(make_pair(ui, e.w));
+// Minimum number of bytes of the input file given to every thread reading it
+#define MIN_CHUNK_SIZE (1 << 20)
 
-        // Initializing the distance vector of the nodes
-        dv[ui][ui] = make_pair(0, ui);
-        dv[vi][vi] = make_pair(0, vi);
-        dv[ui][vi] = make_pair(e.w, vi);
-        dv[vi][ui] = make_pair(e.w, ui);
+// The edges read from one chunk of lines of the input file
+class EdgeChunk {
+   public:
+    // The names of the nodes in the order of their first appearance in the chunk
+    // These are views into the input file, so this table does not copy them
+    NodeTable nodes{false};
+
+    // The vertices (as integers of the above table) and the weight of every edge, three entries per edge
+    vector<uint32_t> edges;
+
+    // The number of lines in the chunk
+    ll numLines = 0;
+
+    // The first invalid line of the chunk (-1 if there is none), and the invalid token or line
+    ll errLine = -1;
+    string_view errToken;
+    bool badWeight = false;
+
+    // Returns the number of edges in the chunk
+    size_t size() const {
+        return edges.size() / 3;
     }
-}
+};
 
-// Executes the distance vector routing algorithm on the input graph till convergence
-void distVecRouting(ll numNodes, const vector<vector<pair<ll, ll>>> &gr, vector<vector<pair<ll, ll>>> &dv) {
-    // Initialize nodes numbering from 0 to n-1
-    vector<ll> nodes(numNodes);
-    iota(nodes.begin(), nodes.end(), 0);
+// The input file mapped into the memory along with the edges read from it
+// The file is split at line boundaries into chunks which are tokenized in place by separate threads
+class EdgeFile {
+   public:
+    // The edges read from every chunk of the file, in the order of the chunks in the file
+    vector<EdgeChunk> chunks;
 
-    // Create a random number generator
-    random_device rd;
-    mt19937 generator(rd());
+    // Constructor
+    EdgeFile() : data{nullptr}, size{0}, mapped{false} {}
 
-    // Number of iterations and number of iterations when there is no update
-    int numIter = 0, noUpdate = 0;
+    // Unmaps the file, if it was mapped into the memory
+    ~EdgeFile() {
+        if (mapped) munmap((void *)data, size);
+    }
 
-    // Executing the algorithm
-    while (true) {
-        bool isUpdated = false;  // Whether there update occurs in this iteration
+    // Opens and maps the given file into the memory. Files that can not be mapped are read into a buffer
+    // Returns false if the file could not be opened
+    bool open(const string &fileName) {
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd == -1) return false;
 
-        // Randomly shuffle all the nodes
-        shuffle(nodes.begin(), nodes.end(), generator);
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                // The file is read sequentially from multiple positions, so ask for an aggressive readahead
+                madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                data = (const char *)addr;
+                size = st.st_size;
+                mapped = true;
+            }
+        }
 
-        // Iterate over all the nodes
-        for (auto &u : nodes) {
-            // Take the neighbors of the current node `u`
-            auto neighbors = gr[u];
+        if (!mapped) {
+            // Read the whole file, if it is not a regular file or could not be mapped
+            char buf[1 << 16];
+            ssize_t n;
+            while ((n = read(fd, buf, sizeof(buf))) > 0) buffer.insert(buffer.end(), buf, buf + n);
+            data = buffer.data();
+            size = buffer.size();
+        }
+        close(fd);
+        return true;
+    }
 
-            // make sure all neighbors have an equal probability of picking
-            // range is inclusive, so 0 to m-1
-            uniform_int_distribution<size_t> distribution(0, neighbors.size() - 1);
+    // Splits the file at line boundaries into chunks of almost equal size, one for each thread
+    // and tokenizes all the chunks in parallel
+    void tokenize(ll numThreads) {
+        ll numChunks = max(1LL, min(numThreads, (ll)(size / MIN_CHUNK_SIZE)));
+        vector<size_t> bounds{0};
+        for (ll c = 1; c < numChunks; ++c) {
+            // The chunk ends after the first newline character at or after its target end
+            size_t pos = max(bounds.back(), (size_t)(size * c / numChunks));
+            const char *nl = (const char *)memchr(data + pos, '\n', size - pos);
+            if (nl == nullptr) break;
+            bounds.emplace_back(nl - data + 1);
+        }
+        bounds.emplace_back(size);
 
-            // Generate a random index to pick any random neighbor
-            size_t randIndex = distribution(generator);
-
-            // Take the randomly picked neighbor
-            auto &n = neighbors[randIndex];
-            // The neighbor vertex and weight of the edge u-v
-            ll v = n.first, dist_u_v = n.second;
-
-            // Iterate over all the nodes to update the distance vector of the current node `u`
-            // using the distance vector of the neighbor node `v`
-            for (ll i = 0; i < dv[v].size(); ++i) {
-                // The current distance between the nodes u-i and v-i
-                ll dist_u_i = dv[u][i].first, dist_v_i = dv[v][i].first;
-
-                // If the node `i` is unreachable from `v`, skip
-                if (dist_v_i == INF) continue;
-
-                // If the distance between node v-i plus u-v is less than the distance
-                // between the nodes u-i, then update the distance vector of `u` for the node `i`
-                // via the neighbor `v`
-                if (dist_v_i + dist_u_v < dist_u_i) {
-                    dv[u][i] = make_pair(dist_v_i + dist_u_v, v);
-                    isUpdated = true;  // An update occurred
-                    noUpdate = 0;      // Reset this variable
+        chunks.resize(bounds.size() - 1);
+        parallelFor(chunks.size(), numThreads, [&](ll c, ll) {
+            tokenizeChunk(data + bounds[c], data + bounds[c + 1], chunks[c]);
+        });
+    }
+
+   private:
+    // The contents of the file, and whether they are mapped into the memory or read into the buffer
+    const char *data;
+    size_t size;
+    bool mapped;
+    vector<char> buffer;
+
+    // Whether the given character separates the tokens of a line
+    static bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    // Reads the edges from the lines between `p` and `end`, every line having the vertices and the weight of an edge
+    // Stops at the first invalid line, recording it in the chunk
+    static void tokenizeChunk(const char *p, const char *end, EdgeChunk &chunk) {
+        chunk.edges.reserve((end - p) / 8);
+        while (p < end) {
+            const char *eol = (const char *)memchr(p, '\n', end - p);
+            if (eol == nullptr) eol = end;
+
+            // Split the line into at most four tokens, the fourth one being an error
+            string_view tokens[4];
+            int numTokens = 0;
+            for (const char *q = p; numTokens < 4;) {
+                while (q < eol && isBlank(*q)) ++q;
+                if (q == eol) break;
+                const char *start = q;
+                while (q < eol && !isBlank(*q)) ++q;
+                tokens[numTokens++] = string_view(start, q - start);
+            }
+
+            if (numTokens == 3) {
+                // Try converting weight to integer
+                const string_view &w = tokens[2];
+                ll wl = 0;
+                auto res = from_chars(w.data(), w.data() + w.size(), wl);
+
+                // For this question weight should be a positive integer
+                // less than 100000
+                if (res.ec != errc() || res.ptr != w.data() + w.size() || wl <= 0 || wl >= MAX_EDGE_WEIGHT) {
+                    chunk.errLine = chunk.numLines;
+                    chunk.errToken = w;
+                    chunk.badWeight = true;
+                    return;
                 }
+
+                chunk.edges.emplace_back(chunk.nodes.intern(tokens[0]));
+                chunk.edges.emplace_back(chunk.nodes.intern(tokens[1]));
+                chunk.edges.emplace_back((uint32_t)wl);
+            } else if (numTokens != 0) {
+                // Every non-empty line should have exactly three tokens
+                chunk.errLine = chunk.numLines;
+                chunk.errToken = string_view(p, eol - p);
+                return;
             }
+
+            ++chunk.numLines;
+            p = eol + 1;
         }
+    }
+};
 
-        ++numIter;                   // Increment the number of iterations
-        if (!isUpdated) ++noUpdate;  // Increment if there is no update
+// Reads input edges from the given filename
+// and fills them inside the chunks of the input edge file
+void readEdges(string fileName, ll numThreads, EdgeFile &file) {
+    // If the file was not able to open, exit with failure status
+    if (!file.open(fileName)) {
+        std::cout << "File '" << fileName << "' could not be opened!\n";
+        exit(EXIT_FAILURE);
+    }
 
-        // If we reached max count when there are no updates, we conclude that convergence has occurred
-        if (noUpdate == MAX_NO_UPDATE_CONV) {
-            numIter -= (noUpdate - 1);  // Subtract the extra iterations added from the actual convergence
-            break;
+    // Read the edges from all the chunks of the file
+    file.tokenize(numThreads);
+
+    // Report the first invalid line of the file, if any
+    ll line = 1;
+    for (const EdgeChunk &chunk : file.chunks) {
+        if (chunk.errLine == -1) {
+            line += chunk.numLines;
+            continue;
+        }
+        if (chunk.badWeight) {
+            std::cout << "The weight of an edge between two nodes should be a positive integer less than 100,000, but got '" << chunk.errToken << "'\n";
+        } else {
+            std::cout << "Every line of the input file should be an edge as '<u> <v> <w>', but line " << line + chunk.errLine << " is '" << chunk.errToken << "'\n";
+        }
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Undirected graph of the network stored in the compressed sparse row (CSR) form
+// The neighbors of the node `u` are `adj[offset[u]]` to `adj[offset[u + 1] - 1]` and `weight` holds the
+// weights of those edges. Node numbers, offsets and weights all fit in 32 bits, so every edge takes 8 bytes
+// The three arrays lie one after the other, either in a buffer of the graph or in a snapshot mapped into the memory
+class Graph {
+   public:
+    // The offsets of the adjacency list of every node, followed by the total number of entries
+    uint32_t *offset = nullptr;
+
+    // The concatenated adjacency lists of all the nodes, and the weights of those edges
+    uint32_t *adj = nullptr, *weight = nullptr;
+
+    // Constructor
+    Graph() = default;
+
+    // The graph may own a mapping of the memory, so it is never copied
+    Graph(const Graph &) = delete;
+    Graph &operator=(const Graph &) = delete;
+
+    // Unmaps the snapshot, if the graph was loaded from one
+    ~Graph() {
+        if (mapped != nullptr) munmap(mapped, mappedSize);
+    }
+
+    // The number of nodes in the graph
+    ll numNodes() const {
+        return n;
+    }
+
+    // The number of entries in the adjacency lists, two for every edge
+    size_t numEntries() const {
+        return offset[n];
+    }
+
+    // Allocates the zeroed arrays of a graph with the given number of nodes and adjacency list entries
+    void allocate(ll numNodes, size_t numEntries) {
+        n = numNodes;
+        storage.assign(numNodes + 1 + 2 * numEntries, 0);
+        setArrays(storage.data(), numEntries);
+    }
+
+    // Uses the arrays starting at `arrays` inside the given mapping of the memory, which the graph then owns
+    void attach(void *addr, size_t size, uint32_t *arrays, ll numNodes, size_t numEntries) {
+        n = numNodes;
+        mapped = addr;
+        mappedSize = size;
+        setArrays(arrays, numEntries);
+    }
+
+   private:
+    // The number of nodes
+    ll n = 0;
+
+    // The arrays of a graph built in the memory
+    vector<uint32_t> storage;
+
+    // The snapshot mapped into the memory, if the graph was loaded from one
+    void *mapped = nullptr;
+    size_t mappedSize = 0;
+
+    // Points the arrays at their positions in the given buffer
+    void setArrays(uint32_t *arrays, size_t numEntries) {
+        offset = arrays;
+        adj = offset + n + 1;
+        weight = adj + numEntries;
+    }
+};
+
+// Builds a graph from the edges read from the input file
+// Interns the string name of each node into the node table, which assigns them normalized
+// integer numbers starting from 0 in the order of their first appearance and keeps the reverse mapping
+// The CSR arrays are filled in two passes, the first one counts the degree of every node
+// and the second one places every edge at its final position
+void buildGraph(ll numNodes, const EdgeFile &file, NodeTable &nodes, Graph &gr) {
+    // Intern the names of every chunk in the order of the chunks, so that every node gets the integer
+    // of its first appearance in the file. `chunkNodes[c][i]` is the integer of the node `i` of the chunk `c`
+    vector<vector<uint32_t>> chunkNodes(file.chunks.size());
+    size_t numEdges = 0;
+    for (size_t c = 0; c < file.chunks.size(); ++c) {
+        for (string_view name : file.chunks[c].nodes.names) {
+            chunkNodes[c].emplace_back(nodes.intern(name));
+        }
+        numEdges += file.chunks[c].size();
+    }
+
+    // The provided input number of nodes and number of distinct nodes found in the
+    // input file should be same
+    if (nodes.size() > numNodes) {
+        std::cout << "Number of distinct nodes in the input file is greater than the given number of nodes\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // Every edge is stored in the adjacency list of both of its vertices
+    if (2 * numEdges >= UINT32_MAX) {
+        std::cout << "Number of edges in the input file is too large\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // First pass: loop over all the edges to count the degree of every node
+    gr.allocate(numNodes, 2 * numEdges);
+    for (size_t c = 0; c < file.chunks.size(); ++c) {
+        const vector<uint32_t> &e = file.chunks[c].edges;
+        for (size_t i = 0; i < e.size(); i += 3) {
+            ++gr.offset[chunkNodes[c][e[i]] + 1];
+            ++gr.offset[chunkNodes[c][e[i + 1]] + 1];
         }
     }
 
-    std::cout << "Number of iterations for convergence: " << numIter << "\n\n";
+    // The adjacency list of every node starts where the one of the previous node ends
+    for (ll u = 0; u < numNodes; ++u) {
+        gr.offset[u + 1] += gr.offset[u];
+    }
+
+    // Second pass: push the edge into the adjacency list of both the vertices
+    // keeping the order in which the edges appear in the input file
+    vector<uint32_t> next(gr.offset, gr.offset + numNodes);
+    for (size_t c = 0; c < file.chunks.size(); ++c) {
+        const vector<uint32_t> &e = file.chunks[c].edges;
+        for (size_t i = 0; i < e.size(); i += 3) {
+            uint32_t ui = chunkNodes[c][e[i]], vi = chunkNodes[c][e[i + 1]], w = e[i + 2];
+            gr.adj[next[ui]] = vi;
+            gr.weight[next[ui]++] = w;
+            gr.adj[next[vi]] = ui;
+            gr.weight[next[vi]++] = w;
+        }
+    }
 }
 
-// Generic function to pretty print any input with defined width, alignment and fill character
-template <typename T>
-void prettyPrint(const T &res, ll width, std::ios_base &(*positioning)(std::ios_base &) = std::left, char fillChar = ' ') {
-    ios init(NULL);
-    // copying the default `cout` formatting
-    init.copyfmt(std::cout);
-    // pretty printing the input
-    std::cout << setfill(fillChar) << setw(width) << positioning << res;
-    // resetting the default `cout` formatting
-    std::cout.copyfmt(init);
+// Identifies the graph snapshot files, and the version of their layout
+#define SNAPSHOT_MAGIC "L4GRAPH"
+#define SNAPSHOT_VERSION 1
+
+// The header of a graph snapshot. It is followed by the three CSR arrays of the graph, the offsets of the names
+// of the nodes (64 bits each, the last one being the total length) and the concatenated names padded to
+// a multiple of 4 bytes, so that the whole file is made of 32-bit words and every array is aligned
+class SnapshotHeader {
+   public:
+    // SNAPSHOT_MAGIC along with its terminating null character, and SNAPSHOT_VERSION
+    char magic[8];
+    uint32_t version, reserved;
+
+    // The number of nodes, of adjacency list entries and of named nodes, and the total length of the names
+    uint64_t numNodes, numEntries, numNames, nameBytes;
+
+    // Checksum of everything after the header
+    uint64_t checksum;
+};
+
+// The number of bytes of the CSR arrays of a snapshot, padded so that the name offsets are 8-byte aligned
+size_t snapshotArrayBytes(uint64_t numNodes, uint64_t numEntries) {
+    return ((numNodes + 1 + 2 * numEntries) * sizeof(uint32_t) + 7) / 8 * 8;
 }
 
-// Pretty prints the results obtained from the Distance Vector Routing algorithm
-// Output the local routing table at every node after convergence has occurred
-void printResults(const map<ll, string> &itn, const vector<vector<pair<ll, ll>>> &dv) {
-    prettyPrint("", 5);
-    for (ll i = 0; i < dv.size(); ++i) {
-        std::cout << "  |  ";
-        prettyPrint(itn.find(i)->second, 10);
+// Checksum of the given number of 32-bit words, continuing from the checksum `h` of the words before them
+// Each word is mixed in like the bytes of the FNV-1a hash
+uint64_t snapshotChecksum(const uint32_t *words, size_t numWords, uint64_t h = 14695981039346656037ULL) {
+    for (size_t i = 0; i < numWords; ++i) {
+        h ^= words[i];
+        h *= 1099511628211ULL;
     }
-    std::cout << "\n";
-    prettyPrint("\n", 5 + (15 * dv.size()), std::right, '=');
+    return h;
+}
 
-    // Iterating all the nodes in the network
-    for (int i = 0; i < dv.size(); ++i) {
-        // Convert the node from integer naming to original string name
-        auto currNode = itn.find(i);
+// Whether the given file starts like a graph snapshot
+bool isSnapshot(const string &fileName) {
+    char magic[8] = {};
+    ifstream inFile{fileName, ios::in | ios::binary};
+    inFile.read(magic, sizeof(magic));
+    return inFile && memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
 
-        // If the node is not present in the map, then it does not have any edge in the network
-        // So, its name is unkown
-        prettyPrint(currNode != itn.end() ? currNode->second : "-", 5);
+// Writes the snapshot of the graph and the names of its nodes to the given file
+void saveSnapshot(const string &fileName, const Graph &gr, const NodeTable &nodes) {
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.numNodes = gr.numNodes();
+    header.numEntries = gr.numEntries();
+    header.numNames = nodes.size();
 
-        // Printing the distance vector of the current node
-        for (auto &p : dv[i]) {
-            std::cout << "  |  ";
-            if (p.first == INF) {
-                // If node is unreachable from the current node
-                prettyPrint(make_pair("INF", "-"), 10);
-            } else {
-                // Print the distance of the node from the current node and
-                // the neighbor that should be taken to reach that node from the current node
-                prettyPrint(make_pair(p.first, itn.find(p.second)->second), 10);
-            }
-        }
-        std::cout << "\n";
+    // The arrays of the graph are contiguous, so they are written at once along with their padding
+    size_t arrayWords = gr.numNodes() + 1 + 2 * gr.numEntries();
+    vector<uint32_t> arrayPad(snapshotArrayBytes(header.numNodes, header.numEntries) / sizeof(uint32_t) - arrayWords, 0);
+
+    // The offset of every name and the concatenated names padded to whole words
+    vector<uint64_t> nameOffset{0};
+    for (string_view name : nodes.names) nameOffset.emplace_back(nameOffset.back() + name.size());
+    header.nameBytes = nameOffset.back();
+    vector<uint32_t> names((header.nameBytes + 3) / 4, 0);
+    for (ll i = 0; i < nodes.size(); ++i) {
+        memcpy((char *)names.data() + nameOffset[i], nodes.names[i].data(), nodes.names[i].size());
+    }
+
+    header.checksum = snapshotChecksum(gr.offset, arrayWords);
+    header.checksum = snapshotChecksum(arrayPad.data(), arrayPad.size(), header.checksum);
+    header.checksum = snapshotChecksum((const uint32_t *)nameOffset.data(), 2 * nameOffset.size(), header.checksum);
+    header.checksum = snapshotChecksum(names.data(), names.size(), header.checksum);
+
+    ofstream outFile{fileName, ios::out | ios::binary};
+    outFile.write((const char *)&header, sizeof(header));
+    outFile.write((const char *)gr.offset, arrayWords * sizeof(uint32_t));
+    outFile.write((const char *)arrayPad.data(), arrayPad.size() * sizeof(uint32_t));
+    outFile.write((const char *)nameOffset.data(), nameOffset.size() * sizeof(uint64_t));
+    outFile.write((const char *)names.data(), names.size() * sizeof(uint32_t));
+    outFile.close();
+
+    // If the file could not be written, exit with failure status
+    if (!outFile) {
+        std::cout << "Snapshot '" << fileName << "' could not be written!\n";
+        exit(EXIT_FAILURE);
     }
 }
 
-int main(int argc, char const *argv[]) {
-    // This program requires two arguments from the command line
-    if (argc != 3) {
-        std::cout << "Expected 2 arguments, but received " << argc - 1 << "\n";
-        std::cout << "Please provide the arguments as follows: ./<prog_name.out> <numNodes> <fileName>";
-        return EXIT_FAILURE;
+// Maps the graph snapshot of the given file into the memory and uses its arrays as the graph
+// The names of the nodes are interned as views into the mapping, so the graph must outlive the node table
+// The checksum and the structure of the graph are verified only if asked to, as that reads the whole file
+void loadSnapshot(const string &fileName, bool verify, Graph &gr, NodeTable &nodes) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) != 0) {
+        std::cout << "File '" << fileName << "' could not be opened!\n";
+        exit(EXIT_FAILURE);
     }
 
-    // Getting the number of nodes in the network
-    ll numNodes;
-    try {
-        numNodes = stringToLong(argv[1]);
-        if (numNodes <= 0) throw exception();
-    } catch (exception &e) {
-        std::cout << "Number of nodes should be provided as a positive integer, got '" << argv[1] << "'\n";
-        return EXIT_FAILURE;
+    // A private writable mapping, so that the weights can be updated without touching the file
+    size_t size = st.st_size;
+    void *addr = size < sizeof(SnapshotHeader) ? MAP_FAILED : mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        std::cout << "Snapshot '" << fileName << "' could not be mapped into the memory\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // The sizes in the header should add up to the size of the file
+    const SnapshotHeader &header = *(const SnapshotHeader *)addr;
+    size_t arrayBytes = snapshotArrayBytes(header.numNodes, header.numEntries);
+    size_t nameOffsetBytes = (header.numNames + 1) * sizeof(uint64_t);
+    size_t nameWordBytes = (header.nameBytes + 3) / 4 * 4;
+    if (header.version != SNAPSHOT_VERSION || header.numNodes >= UINT32_MAX || header.numEntries >= UINT32_MAX ||
+        header.numNames > header.numNodes || header.nameBytes > size ||
+        sizeof(SnapshotHeader) + arrayBytes + nameOffsetBytes + nameWordBytes != size) {
+        std::cout << "Snapshot '" << fileName << "' has an unsupported version or is corrupted\n";
+        exit(EXIT_FAILURE);
+    }
+
+    char *body = (char *)addr + sizeof(SnapshotHeader);
+    uint32_t *arrays = (uint32_t *)body;
+    const uint64_t *nameOffset = (const uint64_t *)(body + arrayBytes);
+    const char *names = body + arrayBytes + nameOffsetBytes;
+    gr.attach(addr, size, arrays, header.numNodes, header.numEntries);
+
+    if (verify) {
+        bool valid = snapshotChecksum(arrays, (size - sizeof(SnapshotHeader)) / 4) == header.checksum;
+        valid = valid && gr.offset[0] == 0 && gr.offset[gr.numNodes()] == header.numEntries;
+        for (ll u = 0; valid && u < gr.numNodes(); ++u) {
+            valid = gr.offset[u] <= gr.offset[u + 1];
+        }
+        for (size_t j = 0; valid && j < header.numEntries; ++j) {
+            valid = gr.adj[j] < gr.numNodes() && gr.weight[j] > 0 && gr.weight[j] < MAX_EDGE_WEIGHT;
+        }
+        if (!valid || nameOffset[header.numNames] != header.nameBytes) {
+            std::cout << "Snapshot '" << fileName << "' failed the verification\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Every name should get the integer of its position in the snapshot
+    nodes.reserve(header.numNames);
+    for (uint64_t i = 0; i < header.numNames; ++i) {
+        if (nameOffset[i] > nameOffset[i + 1] || nameOffset[i + 1] > header.nameBytes ||
+            nodes.internView(string_view(names + nameOffset[i], nameOffset[i + 1] - nameOffset[i])) != (ll)i) {
+            std::cout << "Snapshot '" << fileName << "' has an invalid table of the node names\n";
+            exit(EXIT_FAILURE);
+        }
     }
+}
 
-    string fileName = argv[2];  // The filename containing edges information
+// Builds the graph from the given file, which is either a text file of edges or a graph snapshot
+// Also saves the snapshot of the graph, if asked to. Every step ends a phase of the timer
+void loadGraph(ll numNodes, const string &fileName, const Options &opts, NodeTable &nodes, Graph &gr, PhaseTimer &timer) {
+    if (isSnapshot(fileName)) {
+        loadSnapshot(fileName, opts.verifySnapshot, gr, nodes);
+        timer.lap("load");
 
-    // Reading the input edges from the file
-    vector<Edge> edges;
-    readEdges(fileName, edges);
+        // The rows of the routing tables depend on the number of nodes, so it should be the one of the snapshot
+        if (gr.numNodes() != numNodes) {
+            std::cout << "Snapshot '" << fileName << "' has " << gr.numNodes() << " nodes, but " << numNodes << " were given\n";
+            exit(EXIT_FAILURE);
+        }
+    } else {
+        // Reading the input edges from the file
+        EdgeFile edges;
+        readEdges(fileName, opts.threads, edges);
+        timer.lap("parse");
+
+        // Constructing the graph from the edges, and
+        // constructing the table of integer names for the string names of the nodes
+        buildGraph(numNodes, edges, nodes, gr);
+        timer.lap("build");
+    }
 
-    // Constructing the graph from the edges, and
-    // constructing the map and reverse map from string name to integer name for the nodes
-    // and initializing the distance vector for all the nodes
-    map<string, ll> nodeToInt;
-    map<ll, string> intToNode;
-    vector<vector<pair<ll, ll>>> graph;
-    vector<vector<pair<ll, ll>>> distVec;
-    buildGraph(numNodes, edges, nodeToInt, intToNode, graph, distVec);
+    if (!opts.saveSnapshot.empty()) {
+        saveSnapshot(opts.saveSnapshot, gr, nodes);
+        timer.lap("save-snapshot");
+    }
+}
 
-    // Executing the Distance Vector Routing algorithm
-    distVecRouting(numNodes, graph, distVec);
+// Updates the row `du` of distances and `hu` of next hops of a node with the row `dv` of its neighbor `via`
+// at the distance `w`, over `count` entries. Returns the number of entries updated
+// The entries are selected with masks instead of branches, so the loop can be turned into vector instructions
+uint32_t relaxRowScalar(uint32_t *__restrict du, uint32_t *__restrict hu, const uint32_t *__restrict dv, uint32_t w, uint32_t via, size_t count) {
+    uint32_t numUpdates = 0;
+    for (size_t i = 0; i < count; ++i) {
+        // The node `i` should be reachable from `via`, which also keeps the sum from overflowing
+        uint32_t d = dv[i] + w;
+        uint32_t better = -(uint32_t)((dv[i] < DV_INF - w) & (d < du[i]));
+        du[i] = (d & better) | (du[i] & ~better);
+        hu[i] = (via & better) | (hu[i] & ~better);
+        numUpdates -= better;
+    }
+    return numUpdates;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// The vector kernels below work like `relaxRowScalar`, on rows aligned to a cache line whose length is a multiple
+// of DV_ROW_ALIGN. Only the shortest routes are known to fit in 32 bits (checked by `initDistVec`), so the sum
+// saturates at DV_INF: the distances of `dv` are capped at DV_INF - w before adding `w`, which also keeps the
+// unreachable entries at DV_INF. The new distance is then the unsigned minimum, and the entries where it differs
+// from the old one take `via` as the next hop
+
+// Updates the row four entries at a time with SSE4.1 instructions
+__attribute__((target("sse4.1"))) uint32_t relaxRowSse4(uint32_t *__restrict du, uint32_t *__restrict hu, const uint32_t *__restrict dv, uint32_t w, uint32_t via, size_t count) {
+    const __m128i inf = _mm_set1_epi32(-1), weight = _mm_set1_epi32(w), cap = _mm_set1_epi32(DV_INF - w), hop = _mm_set1_epi32(via);
+    uint32_t numUpdates = 0;
+    for (size_t i = 0; i < count; i += 4) {
+        __m128i v = _mm_load_si128((const __m128i *)(dv + i)), u = _mm_load_si128((const __m128i *)(du + i));
+        __m128i d = _mm_add_epi32(_mm_min_epu32(v, cap), weight);
+        __m128i best = _mm_min_epu32(d, u);
+        __m128i better = _mm_xor_si128(_mm_cmpeq_epi32(best, u), inf);
+        _mm_store_si128((__m128i *)(du + i), best);
+        __m128i h = _mm_load_si128((const __m128i *)(hu + i));
+        _mm_store_si128((__m128i *)(hu + i), _mm_blendv_epi8(h, hop, better));
+        numUpdates += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(better)));
+    }
+    return numUpdates;
+}
+
+// Updates the row eight entries at a time with AVX2 instructions
+__attribute__((target("avx2"))) uint32_t relaxRowAvx2(uint32_t *__restrict du, uint32_t *__restrict hu, const uint32_t *__restrict dv, uint32_t w, uint32_t via, size_t count) {
+    const __m256i inf = _mm256_set1_epi32(-1), weight = _mm256_set1_epi32(w), cap = _mm256_set1_epi32(DV_INF - w), hop = _mm256_set1_epi32(via);
+    uint32_t numUpdates = 0;
+    for (size_t i = 0; i < count; i += 8) {
+        __m256i v = _mm256_load_si256((const __m256i *)(dv + i)), u = _mm256_load_si256((const __m256i *)(du + i));
+        __m256i d = _mm256_add_epi32(_mm256_min_epu32(v, cap), weight);
+        __m256i best = _mm256_min_epu32(d, u);
+        __m256i better = _mm256_xor_si256(_mm256_cmpeq_epi32(best, u), inf);
+        _mm256_store_si256((__m256i *)(du + i), best);
+        __m256i h = _mm256_load_si256((const __m256i *)(hu + i));
+        _mm256_store_si256((__m256i *)(hu + i), _mm256_blendv_epi8(h, hop, better));
+        numUpdates += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(better)));
+    }
+    return numUpdates;
+}
+#endif
+
+// A kernel updating a row of the dense distance vectors
+using RelaxRowFn = uint32_t (*)(uint32_t *__restrict, uint32_t *__restrict, const uint32_t *__restrict, uint32_t, uint32_t, size_t);
+
+// Returns the name of the given kernel
+string rowKernelName(RowKernel kernel) {
+    return kernel == RowKernel::AVX2 ? "avx2" : kernel == RowKernel::SSE4 ? "sse4" : kernel == RowKernel::SCALAR ? "scalar" : "auto";
+}
+
+// Resolves AUTO to the widest kernel supported by the processor running the program
+// Exits with failure status if the chosen kernel is not supported by it
+RowKernel resolveRowKernel(RowKernel kernel) {
+    bool hasSse4 = false, hasAvx2 = false;
+#if defined(__x86_64__) || defined(__i386__)
+    hasSse4 = __builtin_cpu_supports("sse4.1");
+    hasAvx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (kernel == RowKernel::AUTO) return hasAvx2 ? RowKernel::AVX2 : hasSse4 ? RowKernel::SSE4 : RowKernel::SCALAR;
+    if ((kernel == RowKernel::SSE4 && !hasSse4) || (kernel == RowKernel::AVX2 && !hasAvx2)) {
+        std::cout << "The processor does not support the " << rowKernelName(kernel) << " kernel\n";
+        exit(EXIT_FAILURE);
+    }
+    return kernel;
+}
+
+// Returns the function of the given kernel, which should be supported by the processor
+RelaxRowFn relaxRowFunction(RowKernel kernel) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (kernel == RowKernel::AVX2) return relaxRowAvx2;
+    if (kernel == RowKernel::SSE4) return relaxRowSse4;
+#endif
+    return relaxRowScalar;
+}
+
+// Frees the memory given by `aligned_alloc`
+class AlignedFree {
+   public:
+    void operator()(uint32_t *p) const {
+        free(p);
+    }
+};
+
+// The distance vectors of all the nodes as two dense V x V matrices of 32-bit distances and next hops
+// kept apart (struct of arrays), so that updating a vector from the one of a neighbor streams over
+// contiguous rows. Every row is padded to whole cache lines, so the rows can be read with aligned vector loads
+class DenseDistVec {
+   public:
+    // Constructor, the rows are updated with the given kernel
+    DenseDistVec(RowKernel kernel) : relaxRow{relaxRowFunction(kernel)} {}
+
+    // Sets all the entries of the vectors of `numNodes` nodes as unreachable
+    void reset(ll numNodes) {
+        reset(numNodes, numNodes);
+    }
+
+    // Sets all the entries of the vectors of `numNodes` nodes to `numDests` destinations as unreachable
+    // The destinations need not be nodes, the area routing keeps a vector of the areas at every node
+    void reset(ll numNodes, ll numDests) {
+        n = numNodes;
+        stride = (numDests + DV_ROW_ALIGN - 1) / DV_ROW_ALIGN * DV_ROW_ALIGN;
+        size_t bytes = n * stride * sizeof(uint32_t);
+        dist.reset((uint32_t *)aligned_alloc(64, max(bytes, (size_t)64)));
+        hop.reset((uint32_t *)aligned_alloc(64, max(bytes, (size_t)64)));
+        if (dist == nullptr || hop == nullptr) {
+            std::cout << "The distance vectors of " << n << " nodes do not fit in the memory\n";
+            exit(EXIT_FAILURE);
+        }
+        fill(dist.get(), dist.get() + n * stride, DV_INF);
+        fill(hop.get(), hop.get() + n * stride, DV_INF);
+    }
+
+    // Sets the distance from the node `u` to the node `i` and the neighbor of `u` to take to reach it
+    void set(ll u, ll i, uint32_t d, uint32_t via) {
+        dist[u * stride + i] = d;
+        hop[u * stride + i] = via;
+    }
+
+    // Returns the distance from the node `u` to the node `i` (INF if unreachable) and the neighbor to take
+    pair<ll, ll> entry(ll u, ll i) const {
+        uint32_t d = dist[u * stride + i];
+        return d == DV_INF ? make_pair(INF, -1LL) : make_pair((ll)d, (ll)hop[u * stride + i]);
+    }
+
+    // Updates the distance vector of the node `u` using the one of its neighbor `v` at the distance `w`
+    // taken from the vectors `src`, which may be these vectors. Returns the number of entries updated
+    ll relax(ll u, const DenseDistVec &src, ll v, uint32_t w) {
+        return relaxRow(dist.get() + u * stride, hop.get() + u * stride, src.dist.get() + v * stride, w, v, stride);
+    }
+
+    // Copies the distance vector of the node `u` from the vectors `src` of as many nodes
+    void copyRow(ll u, const DenseDistVec &src) {
+        copy(src.dist.get() + u * stride, src.dist.get() + (u + 1) * stride, dist.get() + u * stride);
+        copy(src.hop.get() + u * stride, src.hop.get() + (u + 1) * stride, hop.get() + u * stride);
+    }
+
+    // Computes the routes of all the pairs of nodes of the graph with the blocked Floyd-Warshall algorithm, starting
+    // from the vectors filled by `initDistVec`. The matrices are split into square tiles, and the tiles of every
+    // block of intermediate nodes are updated in three phases: the tile on the diagonal, the other tiles of its row
+    // and column, and all the remaining tiles. The tiles of a phase are independent, so they are shared by the threads
+    void floydWarshall(const Graph &gr, ll numThreads) {
+        // The direct routes take the lightest of the parallel links
+        for (ll u = 0; u < n; ++u) {
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                uint32_t v = gr.adj[j];
+                if (gr.weight[j] < dist[u * stride + v]) set(u, v, gr.weight[j], v);
+            }
+        }
+
+        ll numTiles = (n + FW_TILE_SIZE - 1) / FW_TILE_SIZE;
+        for (ll kt = 0; kt < numTiles; ++kt) {
+            updateTile(kt, kt, kt);
+            parallelFor(2 * numTiles, numThreads, [&](ll t, ll) {
+                if (t / 2 != kt) updateTile(t % 2 == 0 ? kt : t / 2, t % 2 == 0 ? t / 2 : kt, kt);
+            });
+            parallelFor(numTiles * numTiles, numThreads, [&](ll t, ll) {
+                if (t / numTiles != kt && t % numTiles != kt) updateTile(t / numTiles, t % numTiles, kt);
+            });
+        }
+    }
+
+   private:
+    // The number of nodes and of entries in every padded row
+    ll n = 0;
+    size_t stride = 0;
+
+    // The distance and the next hop of every entry, row by row
+    unique_ptr<uint32_t[], AlignedFree> dist, hop;
+
+    // The kernel updating a row
+    RelaxRowFn relaxRow;
+
+    // Updates the tile at the row `it` and the column `jt` of the tiles with the routes through the nodes of
+    // the tile `kt` on the diagonal. Every row of the tile is a row update through the intermediate node `k`
+    // at the distance of the route to `k`, which then takes the neighbor of the route to `k`
+    void updateTile(ll it, ll jt, ll kt) {
+        size_t jb = jt * FW_TILE_SIZE, count = min((size_t)FW_TILE_SIZE, stride - jb);
+        for (ll k = kt * FW_TILE_SIZE; k < min(n, (kt + 1) * FW_TILE_SIZE); ++k) {
+            for (ll i = it * FW_TILE_SIZE; i < min(n, (it + 1) * FW_TILE_SIZE); ++i) {
+                // The row of `k` itself does not change, as the distance from `k` to itself is 0
+                uint32_t d = dist[i * stride + k];
+                if (i == k || d == DV_INF) continue;
+                relaxRow(dist.get() + i * stride + jb, hop.get() + i * stride + jb, dist.get() + k * stride + jb, d, hop[i * stride + k], count);
+            }
+        }
+    }
+};
+
+// The distance vectors of all the nodes keeping only the reachable destinations of every node
+// in increasing order, with their 32-bit distances and next hops kept apart (struct of arrays)
+// Takes less memory than the dense matrices while the nodes reach only a small part of the network
+class SparseDistVec {
+   public:
+    // Sets all the entries of the vectors of `numNodes` nodes as unreachable
+    void reset(ll numNodes) {
+        dest.assign(numNodes, {});
+        dist.assign(numNodes, {});
+        hop.assign(numNodes, {});
+    }
+
+    // Sets the distance from the node `u` to the node `i` and the neighbor of `u` to take to reach it
+    void set(ll u, ll i, uint32_t d, uint32_t via) {
+        size_t k = lower_bound(dest[u].begin(), dest[u].end(), (uint32_t)i) - dest[u].begin();
+        if (k == dest[u].size() || dest[u][k] != i) {
+            dest[u].insert(dest[u].begin() + k, i);
+            dist[u].insert(dist[u].begin() + k, d);
+            hop[u].insert(hop[u].begin() + k, via);
+        } else {
+            dist[u][k] = d;
+            hop[u][k] = via;
+        }
+    }
+
+    // Returns the distance from the node `u` to the node `i` (INF if unreachable) and the neighbor to take
+    pair<ll, ll> entry(ll u, ll i) const {
+        size_t k = lower_bound(dest[u].begin(), dest[u].end(), (uint32_t)i) - dest[u].begin();
+        if (k == dest[u].size() || dest[u][k] != i) return make_pair(INF, -1LL);
+        return make_pair((ll)dist[u][k], (ll)hop[u][k]);
+    }
+
+    // Updates the distance vector of the node `u` using the one of its neighbor `v` at the distance `w`
+    // taken from the vectors `src`, which may be these vectors. The destinations both reach are updated in place
+    // Only if `v` reaches destinations new to `u`, both the sorted vectors are merged into the buffers of the
+    // calling thread, which are then swapped with the vector of `u`
+    // The routes whose length does not fit in 32 bits are left out, as only the shortest ones are known to fit
+    // Returns the number of entries updated, the destinations new to `u` included
+    ll relax(ll u, const SparseDistVec &src, ll v, uint32_t w) {
+        const vector<uint32_t> &ud = dest[u], &vd = src.dest[v], &vDist = src.dist[v];
+        ll numUpdates = 0, numNew = 0;
+        for (size_t a = 0, b = 0; b < vd.size(); ++b) {
+            while (a < ud.size() && ud[a] < vd[b]) ++a;
+            if (vDist[b] >= DV_INF - w) {
+                // The route via `v` is too long to keep
+                continue;
+            } else if (a == ud.size() || ud[a] != vd[b]) {
+                // Only `v` reaches this destination, which is new to `u`
+                ++numNew;
+            } else if (vDist[b] + w < dist[u][a]) {
+                // Both reach it, and the route via `v` is shorter
+                dist[u][a] = vDist[b] + w;
+                hop[u][a] = v;
+                ++numUpdates;
+            }
+        }
+        if (numNew == 0) return numUpdates;
+
+        // The buffers of the merged vector, which get the old vector of the node after it is updated
+        static thread_local vector<uint32_t> mergedDest, mergedDist, mergedHop;
+        auto keep = [&](uint32_t i, uint32_t d, uint32_t via) {
+            mergedDest.emplace_back(i);
+            mergedDist.emplace_back(d);
+            mergedHop.emplace_back(via);
+        };
+        mergedDest.clear();
+        mergedDist.clear();
+        mergedHop.clear();
+        size_t a = 0, b = 0;
+        while (a < ud.size() || b < vd.size()) {
+            if (b == vd.size() || (a < ud.size() && ud[a] < vd[b])) {
+                // Only `u` reaches this destination
+                keep(ud[a], dist[u][a], hop[u][a]);
+                ++a;
+            } else if (a == ud.size() || vd[b] < ud[a]) {
+                // Only `v` reaches this destination, kept if the route via `v` is not too long
+                if (vDist[b] < DV_INF - w) keep(vd[b], vDist[b] + w, v);
+                ++b;
+            } else {
+                // Both reach it, already updated above
+                keep(ud[a], dist[u][a], hop[u][a]);
+                ++a;
+                ++b;
+            }
+        }
+        dest[u].swap(mergedDest);
+        dist[u].swap(mergedDist);
+        hop[u].swap(mergedHop);
+        return numUpdates + numNew;
+    }
+
+    // Copies the distance vector of the node `u` from the vectors `src` of as many nodes
+    void copyRow(ll u, const SparseDistVec &src) {
+        dest[u] = src.dest[u];
+        dist[u] = src.dist[u];
+        hop[u] = src.hop[u];
+    }
+
+   private:
+    // The reachable destinations of every node, and their distances and next hops
+    vector<vector<uint32_t>> dest, dist, hop;
+};
+
+// Finds the distances of the shortest routes from the node `s` to the nodes of its component, which should all be INF
+// in `dist`. Fills `reached` with these nodes in the order they are settled, so the farthest one comes last
+// The distances are kept in 64 bits, as they may not fit in the 32 bits of the distance vectors
+void shortestDistances(const Graph &gr, ll s, vector<ll> &dist, vector<uint32_t> &reached) {
+    priority_queue<pair<ll, uint32_t>, vector<pair<ll, uint32_t>>, greater<pair<ll, uint32_t>>> pq;
+    reached.clear();
+    dist[s] = 0;
+    pq.emplace(0, s);
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) continue;
+        reached.emplace_back(u);
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            uint32_t v = gr.adj[j];
+            if (d + gr.weight[j] >= dist[v]) continue;
+            dist[v] = d + gr.weight[j];
+            pq.emplace(dist[v], v);
+        }
+    }
+}
+
+// Returns a bound on the length of the shortest route between any two nodes of the same component, found with one
+// search from a node of each component: a route between two nodes is no longer than the sum of their distances to
+// it, so twice its farthest distance. If the links may change weight, up to `maxWeight`, or go down, the bound is
+// instead the longest route a component can have, over all its nodes with links of that weight
+// Exits with failure status unless the bound plus a link weight fits in the 32 bits of the distance vectors
+ll distanceBound(const Graph &gr, ll maxWeight, bool linksMayChange) {
+    ll numNodes = gr.numNodes(), bound = 0;
+    for (size_t j = 0; j < gr.numEntries(); ++j) maxWeight = max(maxWeight, (ll)gr.weight[j]);
+    vector<ll> dist(numNodes, INF);
+    vector<uint32_t> reached;
+    for (ll s = 0; s < numNodes; ++s) {
+        if (gr.offset[s] == gr.offset[s + 1] || dist[s] != INF) continue;
+        shortestDistances(gr, s, dist, reached);
+        bound = max(bound, linksMayChange ? (ll)(reached.size() - 1) * maxWeight : 2 * dist[reached.back()]);
+    }
+    if (bound >= (ll)DV_INF - maxWeight) {
+        std::cout << "The distances of a network of " << numNodes << " nodes with links of weight " << maxWeight << " may not fit in 32 bits\n";
+        exit(EXIT_FAILURE);
+    }
+    return bound;
+}
+
+// Initializes the distance vector of each node from the links to its neighbors
+// The adjacency lists keep the order of the input file, so the last of the parallel links sets the distance
+// The distances are kept in 32 bits, so the shortest routes should fit in them
+template <typename DistVec>
+void initDistVec(ll numNodes, const Graph &gr, DistVec &dv) {
+    distanceBound(gr, 0, false);
+
+    // Initialize the distance vector for each node with distance as INFINITY and no neighbor
+    dv.reset(numNodes);
+
+    for (ll u = 0; u < numNodes; ++u) {
+        // Only the nodes having a link know the distance to themselves
+        if (gr.offset[u] == gr.offset[u + 1]) continue;
+        dv.set(u, u, 0, u);
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            // A loop never shortens the distance of a node to itself
+            if (gr.adj[j] != u) dv.set(u, gr.adj[j], gr.weight[j], gr.adj[j]);
+        }
+    }
+}
+
+// Executes the distance vector routing algorithm on the input graph till convergence
+// The order of the nodes and the neighbors they pick come from a generator with the given seed, so a seed always
+// gives the same run. Fills the number of distance vector entries updated in every iteration up to the convergence,
+// and the number of distance vectors sent from a node to a neighbor
+template <typename DistVec>
+void distVecRouting(ll numNodes, const Graph &gr, uint32_t seed, DistVec &dv, vector<ll> &updates, ll &numMessages) {
+    // Initialize nodes numbering from 0 to n-1
+    vector<ll> nodes(numNodes);
+    iota(nodes.begin(), nodes.end(), 0);
+
+    // Create a random number generator
+    mt19937 generator(seed);
+
+    // Number of iterations and number of iterations when there is no update
+    int numIter = 0, noUpdate = 0;
+
+    // Executing the algorithm
+    updates.clear();
+    numMessages = 0;
+    while (true) {
+        bool isUpdated = false;  // Whether there update occurs in this iteration
+        ll numUpdates = 0;       // The number of entries updated in this iteration
+
+        // Randomly shuffle all the nodes
+        shuffle(nodes.begin(), nodes.end(), generator);
+
+        // Iterate over all the nodes
+        for (auto &u : nodes) {
+            // Take the range of the neighbors of the current node `u` in the adjacency array
+            uint32_t begin = gr.offset[u], end = gr.offset[u + 1];
+
+            // A node without any edge has no neighbor to learn from
+            if (begin == end) continue;
+
+            // make sure all neighbors have an equal probability of picking
+            // range is inclusive, so 0 to m-1
+            uniform_int_distribution<size_t> distribution(0, end - begin - 1);
+
+            // Generate a random index to pick any random neighbor
+            size_t randIndex = begin + distribution(generator);
+
+            // The randomly picked neighbor vertex and weight of the edge u-v
+            // A loop leads back to `u`, which has nothing to learn from itself
+            ll v = gr.adj[randIndex], dist_u_v = gr.weight[randIndex];
+            if (v == u) continue;
+
+            // Update the distance vector of the current node `u` using the distance vector of the neighbor node `v`
+            // For every node `i` reachable from `v`, if the distance between node v-i plus u-v is less than
+            // the distance between the nodes u-i, then the distance vector of `u` for the node `i` goes via `v`
+            ll numRelaxed = dv.relax(u, dv, v, dist_u_v);
+            ++numMessages;
+            if (numRelaxed != 0) {
+                isUpdated = true;  // An update occurred
+                noUpdate = 0;      // Reset this variable
+                numUpdates += numRelaxed;
+            }
+        }
+
+        ++numIter;                   // Increment the number of iterations
+        if (!isUpdated) ++noUpdate;  // Increment if there is no update
+        updates.emplace_back(numUpdates);
+
+        // If we reached max count when there are no updates, we conclude that convergence has occurred
+        if (noUpdate == MAX_NO_UPDATE_CONV) {
+            numIter -= (noUpdate - 1);  // Subtract the extra iterations added from the actual convergence
+            updates.resize(numIter);
+            break;
+        }
+    }
+}
+
+// Executes the synchronous (Bellman-Ford) distance vector routing algorithm on the input graph till convergence
+// Every round, each node merges the vectors of all its neighbors from the previous round into its own, so the rounds
+// read one set of vectors and write the other, which are swapped at the end of the round. The nodes are split into
+// blocks shared by the threads. The neighbors are merged in the order of the adjacency lists and only a strictly
+// shorter route replaces an entry, so the result does not depend on the number of threads
+// The algorithm has converged after the first round without any update. The vectors `next` are used as the buffer
+// Fills the number of distance vector entries updated in every round up to the convergence,
+// and the number of distance vectors sent from a node to a neighbor
+template <typename DistVec>
+void syncDistVecRouting(ll numNodes, const Graph &gr, ll numThreads, DistVec &dv, DistVec &next, vector<ll> &updates, ll &numMessages) {
+    next.reset(numNodes);
+    ll numBlocks = (numNodes + DV_SYNC_BLOCK_SIZE - 1) / DV_SYNC_BLOCK_SIZE;
+    numThreads = min(numThreads, numBlocks);
+
+    // Executing the rounds, each thread counting the updates of its blocks
+    // Every node receives the vector of every neighbor in every round
+    updates.clear();
+    numMessages = 0;
+    vector<ll> threadUpdates(numThreads);
+    do {
+        fill(threadUpdates.begin(), threadUpdates.end(), 0);
+        parallelFor(numBlocks, numThreads, [&](ll block, ll t) {
+            for (ll u = block * DV_SYNC_BLOCK_SIZE; u < min(numNodes, (block + 1) * DV_SYNC_BLOCK_SIZE); ++u) {
+                next.copyRow(u, dv);
+                for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                    threadUpdates[t] += next.relax(u, dv, gr.adj[j], gr.weight[j]);
+                }
+            }
+        });
+        swap(dv, next);
+        updates.emplace_back(accumulate(threadUpdates.begin(), threadUpdates.end(), 0LL));
+        numMessages += gr.numEntries();
+    } while (updates.back() != 0);
+}
+
+// Executes the event-driven distance vector routing algorithm on the input graph till convergence
+// Every node whose vector changed is queued once to advertise its vector to all its neighbors, which are queued
+// in turn if it changes theirs. Initially all the nodes having a link are queued. A node queued again before
+// it advertised is not queued twice, its advertisement carrying its latest vector. The algorithm has converged
+// exactly when the queue drains, so no idle sweep is needed to detect it
+// The nodes queued while advertising the ones of a round form the next round, which sets the number of rounds
+// Fills the number of distance vector entries updated in every round up to the convergence,
+// and the number of distance vectors sent from a node to a neighbor
+template <typename DistVec>
+void eventDistVecRouting(ll numNodes, const Graph &gr, DistVec &dv, vector<ll> &updates, ll &numMessages) {
+    // The nodes to advertise in this round and in the next one, and whether a node is waiting in either
+    vector<uint32_t> current, next;
+    vector<bool> isQueued(numNodes, false);
+    for (ll u = 0; u < numNodes; ++u) {
+        if (gr.offset[u] == gr.offset[u + 1]) continue;
+        current.emplace_back(u);
+        isQueued[u] = true;
+    }
+
+    updates.clear();
+    numMessages = 0;
+    while (!current.empty()) {
+        ll numUpdates = 0;
+        next.clear();
+        for (uint32_t v : current) {
+            isQueued[v] = false;
+
+            // Send the vector of `v` to all its neighbors, the loops leading back to `v` left out
+            for (uint32_t j = gr.offset[v]; j < gr.offset[v + 1]; ++j) {
+                uint32_t u = gr.adj[j];
+                if (u == v) continue;
+                ll numRelaxed = dv.relax(u, dv, v, gr.weight[j]);
+                ++numMessages;
+                if (numRelaxed == 0) continue;
+                numUpdates += numRelaxed;
+                if (!isQueued[u]) {
+                    next.emplace_back(u);
+                    isQueued[u] = true;
+                }
+            }
+        }
+        updates.emplace_back(numUpdates);
+        current.swap(next);
+    }
+}
+
+// Runs the random distance vector routing algorithm `opts.runs` times on the graph, the run `r` with the seed
+// `seed + r`, and prints the distribution of the number of iterations for convergence as CSV
+// The runs are shared by the threads, every thread running its own on its own vectors of `tables`
+template <typename DistVec>
+void convergenceStudy(ll numNodes, const Graph &gr, const Options &opts, uint32_t seed, vector<DistVec> &tables) {
+    vector<ll> iterations(opts.runs);
+    parallelFor(opts.runs, tables.size(), [&](ll r, ll t) {
+        vector<ll> updates;
+        ll numMessages;
+        initDistVec(numNodes, gr, tables[t]);
+        distVecRouting(numNodes, gr, seed + r, tables[t], updates, numMessages);
+        iterations[r] = updates.size();
+    });
+
+    // The percentiles are the nearest ranks
+    sort(iterations.begin(), iterations.end());
+    auto percentile = [&](ll p) { return iterations[(p * opts.runs + 99) / 100 - 1]; };
+    double mean = accumulate(iterations.begin(), iterations.end(), 0.0) / opts.runs;
+    std::cout << "runs,seed,min,mean,p50,p99,max\n";
+    std::cout << opts.runs << "," << seed << "," << iterations.front() << "," << fixed << setprecision(2) << mean << ",";
+    std::cout << percentile(50) << "," << percentile(99) << "," << iterations.back() << "\n";
+}
+
+// Generic function to pretty print any input with defined width, alignment and fill character
+template <typename T>
+void prettyPrint(const T &res, ll width, std::ios_base &(*positioning)(std::ios_base &) = std::left, char fillChar = ' ') {
+    ios init(NULL);
+    // copying the default `cout` formatting
+    init.copyfmt(std::cout);
+    // pretty printing the input
+    std::cout << setfill(fillChar) << setw(width) << positioning << res;
+    // resetting the default `cout` formatting
+    std::cout.copyfmt(init);
+}
+
+// The traffic and the time taken by the nodes to converge after a link event
+class ExchangeStats {
+   public:
+    // The number of rounds, of triggered updates sent, of entries in them and of their bytes
+    ll rounds = 0, messages = 0, entries = 0, bytes = 0;
+
+    // The wall clock time taken, in microseconds
+    ll micros = 0;
+};
+
+// Fills the reverse of every adjacency list entry, the entry of the other end of the same link
+// The entries are ordered by their two ends, keeping the order of the adjacency lists, so the k-th of the parallel
+// links from `u` to `v` pairs with the k-th from `v` to `u`, and the two entries of every loop are next to each other
+void reverseEntries(const Graph &gr, vector<uint32_t> &reverse) {
+    size_t m = gr.numEntries();
+    reverse.resize(m);
+    vector<uint32_t> owner(m), order(m);
+    for (ll u = 0; u < gr.numNodes(); ++u) fill(owner.begin() + gr.offset[u], owner.begin() + gr.offset[u + 1], u);
+    iota(order.begin(), order.end(), 0);
+    auto ends = [&](uint32_t j) { return make_pair(owner[j], gr.adj[j]); };
+    stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return ends(a) < ends(b); });
+    for (size_t a = 0; a < m; ++a) {
+        uint32_t j = order[a], u = owner[j], v = gr.adj[j];
+        if (u > v) continue;
+
+        // The rank of the entry among the ones from `u` to `v`
+        size_t rank = a - (lower_bound(order.begin(), order.begin() + a, j, [&](uint32_t x, uint32_t) { return ends(x) < make_pair(u, v); }) - order.begin());
+        if (u < v) {
+            // The entries from `v` to `u` start where their ends would be, the reverse is at the same rank among them
+            size_t first = lower_bound(order.begin(), order.end(), j, [&](uint32_t x, uint32_t) { return ends(x) < make_pair(v, u); }) - order.begin();
+            reverse[j] = order[first + rank];
+            reverse[order[first + rank]] = j;
+        } else {
+            // The loop pairs with the entry next to it
+            reverse[j] = order[rank % 2 == 0 ? a + 1 : a - 1];
+        }
+    }
+}
+
+// Distance vector protocol reconverging after the links fail or change cost, with triggered updates
+// Every node keeps the vector last advertised by the neighbor at the other end of every adjacency list entry,
+// and its route to a destination is the shortest one through the links up. A node whose routes changed sends
+// only the changed entries to its neighbors, and the receivers whose routes change in turn are queued the same
+// way as the event-driven engine. Routes longer than the longest simple path can be are unreachable, which bounds
+// the count to infinity. Split horizon omits from an update the routes through its receiver, whose stale copy
+// is then dropped as a route timeout would, and poison reverse sends them as unreachable
+// The tables are dense: the routes take O(V^2) memory and the heard vectors O(E * V), one per adjacency list entry
+class DvProtocol {
+   public:
+    // Constructor, the routes longer than `infinity` are unreachable
+    DvProtocol(const Graph &gr, uint32_t infinity, bool splitHorizon, bool poisonReverse)
+        : gr{gr}, n{gr.numNodes()}, infinity{infinity}, splitHorizon{splitHorizon}, poisonReverse{poisonReverse} {
+        size_t m = gr.numEntries();
+        cost.assign(gr.weight, gr.weight + m);
+        reverseEntries(gr, reverse);
+
+        // Every node having a link knows only itself, and has it to advertise
+        dist.assign(n * n, DV_INF);
+        hop.assign(n * n, DV_INF);
+        heard.assign(m * n, DV_INF);
+        isChanged.assign(n * n, false);
+        changed.resize(n);
+        isQueued.assign(n, false);
+        for (ll u = 0; u < n; ++u) {
+            if (gr.offset[u] == gr.offset[u + 1]) continue;
+            dist[u * n + u] = 0;
+            hop[u * n + u] = u;
+            markChanged(u, u);
+        }
+    }
+
+    // Returns the distance from the node `u` to the node `i` (INF if unreachable) and the neighbor to take
+    pair<ll, ll> entry(ll u, ll i) const {
+        uint32_t d = dist[u * n + i];
+        return d == DV_INF ? make_pair(INF, -1LL) : make_pair((ll)d, (ll)hop[u * n + i]);
+    }
+
+    // Sets the cost of all the links between the nodes `u` and `v`, DV_INF taking them down
+    // Adds the traffic to the given stats. Returns false if there is no such link
+    bool setCost(ll u, ll v, uint32_t w, ExchangeStats &stats) {
+        traffic = &stats;
+        bool found = false;
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            if (gr.adj[j] != v) continue;
+            found = true;
+            uint32_t k = reverse[j];
+            bool wasDown = cost[j] == DV_INF;
+            cost[j] = cost[k] = w;
+            if (w == DV_INF) continue;
+
+            // A link coming back up starts with no vector heard over it, and both ends send their whole vector
+            if (wasDown) {
+                fill(heard.begin() + (size_t)j * n, heard.begin() + (size_t)(j + 1) * n, DV_INF);
+                fill(heard.begin() + (size_t)k * n, heard.begin() + (size_t)(k + 1) * n, DV_INF);
+                vector<uint32_t> all(n);
+                iota(all.begin(), all.end(), 0);
+                send(u, j, all);
+                send(v, k, all);
+            }
+        }
+
+        // The routes of both ends may go over the link
+        for (ll i = 0; i < n && found; ++i) {
+            recompute(u, i);
+            recompute(v, i);
+        }
+        return found;
+    }
+
+    // Exchanges the triggered updates of the nodes with changed routes till none is left
+    // Adds the traffic to the given stats
+    void converge(ExchangeStats &stats) {
+        auto start = chrono::steady_clock::now();
+        traffic = &stats;
+        vector<uint32_t> current, next, dests;
+        current.swap(queue);
+        while (!current.empty()) {
+            ++stats.rounds;
+            for (uint32_t u : current) {
+                isQueued[u] = false;
+
+                // Take the changed routes of `u`, which may change again while they are sent
+                dests.swap(changed[u]);
+                changed[u].clear();
+                for (uint32_t i : dests) isChanged[u * n + i] = false;
+                for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                    if (cost[j] != DV_INF) send(u, j, dests);
+                }
+            }
+            current.clear();
+            current.swap(queue);
+        }
+        stats.micros += chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+   private:
+    const Graph &gr;
+    ll n;
+
+    // The routes of this length or longer are unreachable
+    uint32_t infinity;
+
+    // Whether the updates omit or poison the routes through their receiver
+    bool splitHorizon, poisonReverse;
+
+    // The cost of the link of every adjacency list entry (DV_INF while down), and the entry of the other direction
+    vector<uint32_t> cost, reverse;
+
+    // The distance and the neighbor to take of every route, and the vector heard over every adjacency list entry
+    vector<uint32_t> dist, hop, heard;
+
+    // The changed routes of every node not sent yet, and the nodes having some, in the order they got them
+    vector<bool> isChanged, isQueued;
+    vector<vector<uint32_t>> changed;
+    vector<uint32_t> queue;
+
+    // The stats the traffic is added to
+    ExchangeStats *traffic = nullptr;
+
+    // Queues the route of the node `u` to the node `i` to be sent
+    void markChanged(ll u, ll i) {
+        if (!isChanged[u * n + i]) {
+            isChanged[u * n + i] = true;
+            changed[u].emplace_back(i);
+        }
+        if (!isQueued[u]) {
+            isQueued[u] = true;
+            queue.emplace_back(u);
+        }
+    }
+
+    // Sends the routes of the node `u` to the given destinations over the adjacency list entry `j`
+    void send(ll u, uint32_t j, const vector<uint32_t> &dests) {
+        ll v = gr.adj[j];
+        uint32_t *vHeard = heard.data() + (size_t)reverse[j] * n;
+        ll numEntries = 0;
+        for (uint32_t i : dests) {
+            uint32_t d = dist[u * n + i];
+            if (hop[u * n + i] == v && i != u) {
+                if (splitHorizon && !poisonReverse) {
+                    // Not sent, the stale copy of the receiver times out
+                    if (vHeard[i] != DV_INF) {
+                        vHeard[i] = DV_INF;
+                        recompute(v, i);
+                    }
+                    continue;
+                }
+                if (poisonReverse) d = DV_INF;
+            }
+            ++numEntries;
+            if (vHeard[i] != d) {
+                vHeard[i] = d;
+                recompute(v, i);
+            }
+        }
+        if (numEntries != 0) {
+            ++traffic->messages;
+            traffic->entries += numEntries;
+            traffic->bytes += DV_UPDATE_HEADER_BYTES + numEntries * DV_UPDATE_ENTRY_BYTES;
+        }
+    }
+
+    // Recomputes the route of the node `u` to the node `i` from the vectors heard over its links up,
+    // the first link in the adjacency list winning the ties. Queues the route to be sent if it changed
+    void recompute(ll u, ll i) {
+        uint32_t best = DV_INF, via = DV_INF;
+        if (u == i && gr.offset[u] != gr.offset[u + 1]) {
+            best = 0;
+            via = u;
+        } else {
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                uint32_t h = heard[(size_t)j * n + i];
+                if (cost[j] == DV_INF || h == DV_INF || cost[j] + h >= min(best, infinity)) continue;
+                best = cost[j] + h;
+                via = gr.adj[j];
+            }
+        }
+        if (best == dist[u * n + i] && via == hop[u * n + i]) return;
+        dist[u * n + i] = best;
+        hop[u * n + i] = via;
+        markChanged(u, i);
+    }
+};
+
+// Pretty prints the results obtained from the Distance Vector Routing algorithm
+// Output the local routing table at every node after convergence has occurred
+template <typename DistVec>
+void printResults(ll numNodes, const NodeTable &nodes, const DistVec &dv) {
+    prettyPrint("", 5);
+    for (ll i = 0; i < numNodes; ++i) {
+        std::cout << "  |  ";
+        prettyPrint(nodes.name(i), 10);
+    }
+    std::cout << "\n";
+    prettyPrint("\n", 5 + (15 * numNodes), std::right, '=');
+
+    // Iterating all the nodes in the network
+    for (ll i = 0; i < numNodes; ++i) {
+        // Convert the node from integer naming to original string name
+        // If the node is not present in the table, then it does not have any edge in the network
+        // So, its name is unkown and it is printed as "-"
+        prettyPrint(nodes.name(i), 5);
+
+        // Printing the distance vector of the current node
+        for (ll k = 0; k < numNodes; ++k) {
+            pair<ll, ll> p = dv.entry(i, k);
+            std::cout << "  |  ";
+            if (p.first == INF) {
+                // If node is unreachable from the current node
+                prettyPrint(make_pair("INF", "-"), 10);
+            } else {
+                // Print the distance of the node from the current node and
+                // the neighbor that should be taken to reach that node from the current node
+                prettyPrint(make_pair(p.first, nodes.name(p.second)), 10);
+            }
+        }
+        std::cout << "\n";
+    }
+}
+
+// Emulation of the distance vector protocol with real message passing. Every node owns a UDP socket bound on the
+// loopback, and sends the changed entries of its vector to its neighbors as binary advertisements with `sendmmsg`,
+// receiving theirs with `recvmmsg`. The routes follow the same rules as DvProtocol. The nodes are shared by a pool
+// of worker threads, each waiting on the sockets of its nodes with epoll, as a thread for every node would not
+// scale to thousands of nodes on one machine
+// The entries still to send over every link are kept until the receiver has room in its socket buffer, which gets
+// a credit of datagrams, so no datagram is ever dropped. The entries carry the latest distances when they are
+// sent. The emulation has converged exactly when no datagram is in flight and no link has entries to send, which
+// is tracked by a single counter of both
+class DvEmulator {
+   public:
+    // Constructor, binds the sockets of all the nodes having a link. The routes longer than `infinity` are unreachable
+    DvEmulator(const Graph &gr, uint32_t infinity, const Options &opts)
+        : gr{gr}, n{gr.numNodes()}, infinity{infinity}, splitHorizon{opts.splitHorizon}, poisonReverse{opts.poisonReverse} {
+        size_t m = gr.numEntries();
+        reverseEntries(gr, reverse);
+        dist.assign(n * n, DV_INF);
+        hop.assign(n * n, DV_INF);
+        heard.assign(m * n, DV_INF);
+        isPending.assign(m * n, 0);
+        pending.resize(m);
+        credits.reset(new atomic<ll>[n]());
+        work = 0;
+
+        // Every node needs a descriptor for its socket
+        rlimit limit;
+        getrlimit(RLIMIT_NOFILE, &limit);
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if ((ll)limit.rlim_cur < n + 64) {
+            std::cout << "The emulation of " << n << " nodes needs more than the " << limit.rlim_cur << " open files allowed\n";
+            exit(EXIT_FAILURE);
+        }
+
+        fds.assign(n, -1);
+        addrs.resize(n);
+        int bufferSize = EMU_RECEIVE_BUFFER;
+        for (ll u = 0; u < n; ++u) {
+            if (gr.offset[u] == gr.offset[u + 1]) continue;
+            sockaddr_in &addr = addrs[u];
+            addr = sockaddr_in{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t addrLen = sizeof(addr);
+            fds[u] = socket(AF_INET, SOCK_DGRAM, 0);
+            if (fds[u] == -1 || setsockopt(fds[u], SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize)) != 0 ||
+                bind(fds[u], (sockaddr *)&addr, sizeof(addr)) != 0 || getsockname(fds[u], (sockaddr *)&addr, &addrLen) != 0) {
+                std::cout << "Could not bind the socket of an emulated node on the loopback: " << strerror(errno) << "\n";
+                exit(EXIT_FAILURE);
+            }
+
+            // The datagrams a receiver can hold, counting twice the size of the largest one for the kernel overhead
+            socklen_t optLen = sizeof(bufferSize);
+            int granted = 0;
+            getsockopt(fds[u], SOL_SOCKET, SO_RCVBUF, &granted, &optLen);
+            ll room = max(1LL, (ll)granted / (2 * (ll)maxDatagramBytes()));
+            if (maxCredits == 0 || room < maxCredits) maxCredits = room;
+
+            // Every node knows only itself, and has it to advertise
+            dist[u * n + u] = 0;
+            hop[u * n + u] = u;
+            markChanged(u, u);
+        }
+    }
+
+    // Closes the sockets
+    ~DvEmulator() {
+        for (int fd : fds) {
+            if (fd != -1) close(fd);
+        }
+    }
+
+    // Returns the distance from the node `u` to the node `i` (INF if unreachable) and the neighbor to take
+    pair<ll, ll> entry(ll u, ll i) const {
+        uint32_t d = dist[u * n + i];
+        return d == DV_INF ? make_pair(INF, -1LL) : make_pair((ll)d, (ll)hop[u * n + i]);
+    }
+
+    // Runs the nodes on `numThreads` worker threads, the node `u` on the thread `u % numThreads`, till convergence
+    // Fills the datagrams, entries and bytes sent and the time taken
+    void run(ll numThreads, ExchangeStats &stats) {
+        numThreads = max(1LL, min(numThreads, n));
+        vector<ExchangeStats> threadStats(numThreads);
+        atomic<bool> done{false};
+        auto start = chrono::steady_clock::now();
+        auto worker = [&](ll t) {
+            // Wait on the sockets of the nodes of the thread
+            int epollFd = epoll_create1(0);
+            for (ll u = t; u < n; u += numThreads) {
+                epoll_event event{};
+                event.events = EPOLLIN;
+                event.data.u64 = u;
+                if (fds[u] != -1 && epoll_ctl(epollFd, EPOLL_CTL_ADD, fds[u], &event) != 0) {
+                    std::cout << "Could not wait on the socket of an emulated node: " << strerror(errno) << "\n";
+                    exit(EXIT_FAILURE);
+                }
+            }
+
+            Batch batch;
+            epoll_event events[EMU_BATCH_SIZE];
+            while (!done) {
+                for (ll u = t; u < n; u += numThreads) {
+                    if (fds[u] != -1) flush(u, batch, threadStats[t]);
+                }
+                int numReady = epoll_wait(epollFd, events, EMU_BATCH_SIZE, 1);
+                for (int e = 0; e < numReady; ++e) receive(events[e].data.u64, batch);
+                if (work == 0) done = true;
+            }
+            close(epollFd);
+        };
+        vector<thread> pool;
+        for (ll t = 1; t < numThreads; ++t) pool.emplace_back(worker, t);
+        worker(0);
+        for (thread &th : pool) th.join();
+
+        for (const ExchangeStats &ts : threadStats) {
+            stats.messages += ts.messages;
+            stats.entries += ts.entries;
+            stats.bytes += ts.bytes;
+        }
+        stats.micros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    }
+
+   private:
+    const Graph &gr;
+    ll n;
+
+    // The routes of this length or longer are unreachable
+    uint32_t infinity;
+
+    // Whether the advertisements omit or poison the routes through their receiver
+    // The distances only decrease, so an omitted route never leaves a shorter stale copy at the receiver
+    bool splitHorizon, poisonReverse;
+
+    // The entry of the other end of every adjacency list entry
+    vector<uint32_t> reverse;
+
+    // The distance and the neighbor to take of every route, and the vector heard over every adjacency list entry
+    // Only the thread of a node touches its routes and the vectors heard by it
+    vector<uint32_t> dist, hop, heard;
+
+    // The destinations whose routes are still to be sent over every adjacency list entry, owned by the thread of
+    // the sender. Kept as bytes rather than bits, so the threads never share a byte
+    vector<uint8_t> isPending;
+    vector<vector<uint32_t>> pending;
+
+    // The socket and the address of every node
+    vector<int> fds;
+    vector<sockaddr_in> addrs;
+
+    // The datagrams sent to every node and not received yet, and the most it can hold
+    unique_ptr<atomic<ll>[]> credits;
+    ll maxCredits = 0;
+
+    // The datagrams in flight plus the adjacency list entries with entries to send, zero once converged
+    atomic<ll> work;
+
+    // The buffers of the datagrams of a system call
+    class Batch {
+       public:
+        mmsghdr headers[EMU_BATCH_SIZE];
+        iovec vecs[EMU_BATCH_SIZE];
+        vector<uint32_t> words = vector<uint32_t>(EMU_BATCH_SIZE * (EMU_HEADER_WORDS + 2 * EMU_MAX_ENTRIES));
+    };
+
+    // The size of the largest advertisement
+    static size_t maxDatagramBytes() {
+        return (EMU_HEADER_WORDS + 2 * EMU_MAX_ENTRIES) * sizeof(uint32_t);
+    }
+
+    // Queues the route of the node `u` to the node `i` to be sent over all its links
+    void markChanged(ll u, ll i) {
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            if (isPending[(size_t)j * n + i]) continue;
+            isPending[(size_t)j * n + i] = 1;
+            if (pending[j].empty()) ++work;
+            pending[j].emplace_back(i);
+        }
+    }
+
+    // Sends the pending entries of the node `u` over all its links, as many datagrams as the receivers have room for
+    void flush(ll u, Batch &batch, ExchangeStats &stats) {
+        ll numDatagrams = 0, numCleared = 0;
+        auto send = [&]() {
+            // The datagrams are in flight before the links they cleared stop counting
+            work += numDatagrams;
+            for (ll sent = 0; sent < numDatagrams;) {
+                int r = sendmmsg(fds[u], batch.headers + sent, numDatagrams - sent, 0);
+                if (r == -1 && errno != EINTR) {
+                    std::cout << "Could not send the advertisements of an emulated node: " << strerror(errno) << "\n";
+                    exit(EXIT_FAILURE);
+                }
+                sent += max(r, 0);
+            }
+            work -= numCleared;
+            numDatagrams = numCleared = 0;
+        };
+
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+            uint32_t v = gr.adj[j];
+            while (!pending[j].empty()) {
+                // Take a credit of the receiver, or leave the entries for later
+                ll taken = credits[v]++;
+                if (taken >= maxCredits) {
+                    --credits[v];
+                    break;
+                }
+
+                // Fill an advertisement with the last pending entries
+                uint32_t *words = batch.words.data() + numDatagrams * (EMU_HEADER_WORDS + 2 * EMU_MAX_ENTRIES);
+                ll numEntries = 0;
+                while (!pending[j].empty() && numEntries < EMU_MAX_ENTRIES) {
+                    uint32_t i = pending[j].back();
+                    pending[j].pop_back();
+                    isPending[(size_t)j * n + i] = 0;
+                    uint32_t d = dist[u * n + i];
+                    if (hop[u * n + i] == v && i != u) {
+                        if (splitHorizon && !poisonReverse) continue;
+                        if (poisonReverse) d = DV_INF;
+                    }
+                    words[EMU_HEADER_WORDS + 2 * numEntries] = i;
+                    words[EMU_HEADER_WORDS + 2 * numEntries + 1] = d;
+                    ++numEntries;
+                }
+                if (pending[j].empty()) ++numCleared;
+                if (numEntries == 0) {
+                    // Everything was omitted, so nothing is sent
+                    --credits[v];
+                    continue;
+                }
+                words[0] = u;
+                words[1] = reverse[j];
+                words[2] = numEntries;
+                batch.vecs[numDatagrams] = iovec{words, (EMU_HEADER_WORDS + 2 * numEntries) * sizeof(uint32_t)};
+                batch.headers[numDatagrams] = mmsghdr{};
+                batch.headers[numDatagrams].msg_hdr.msg_name = &addrs[v];
+                batch.headers[numDatagrams].msg_hdr.msg_namelen = sizeof(addrs[v]);
+                batch.headers[numDatagrams].msg_hdr.msg_iov = &batch.vecs[numDatagrams];
+                batch.headers[numDatagrams].msg_hdr.msg_iovlen = 1;
+                ++stats.messages;
+                stats.entries += numEntries;
+                stats.bytes += batch.vecs[numDatagrams].iov_len;
+                if (++numDatagrams == EMU_BATCH_SIZE) send();
+            }
+        }
+        if (numDatagrams != 0 || numCleared != 0) send();
+    }
+
+    // Receives and applies all the advertisements waiting at the socket of the node `u`
+    void receive(ll u, Batch &batch) {
+        while (true) {
+            for (ll b = 0; b < EMU_BATCH_SIZE; ++b) {
+                batch.vecs[b] = iovec{batch.words.data() + b * (EMU_HEADER_WORDS + 2 * EMU_MAX_ENTRIES), maxDatagramBytes()};
+                batch.headers[b] = mmsghdr{};
+                batch.headers[b].msg_hdr.msg_iov = &batch.vecs[b];
+                batch.headers[b].msg_hdr.msg_iovlen = 1;
+            }
+            int r = recvmmsg(fds[u], batch.headers, EMU_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+            if (r == -1) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                std::cout << "Could not receive the advertisements of an emulated node: " << strerror(errno) << "\n";
+                exit(EXIT_FAILURE);
+            }
+            for (int b = 0; b < r; ++b) {
+                const uint32_t *words = (const uint32_t *)batch.vecs[b].iov_base;
+                uint32_t k = words[1], numEntries = words[2];
+                for (uint32_t e = 0; e < numEntries; ++e) {
+                    uint32_t i = words[EMU_HEADER_WORDS + 2 * e], d = words[EMU_HEADER_WORDS + 2 * e + 1];
+                    if (heard[(size_t)k * n + i] == d) continue;
+                    heard[(size_t)k * n + i] = d;
+                    recompute(u, i);
+                }
+            }
+
+            // The datagrams leave the flight after the entries they changed are pending
+            credits[u] -= r;
+            work -= r;
+        }
+    }
+
+    // Recomputes the route of the node `u` to the node `i` from the vectors heard over its links,
+    // the first link in the adjacency list winning the ties. Queues the route to be sent if it changed
+    void recompute(ll u, ll i) {
+        uint32_t best = DV_INF, via = DV_INF;
+        if (u == i) {
+            best = 0;
+            via = u;
+        } else {
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                uint32_t h = heard[(size_t)j * n + i];
+                if (h == DV_INF || gr.weight[j] + h >= min(best, infinity)) continue;
+                best = gr.weight[j] + h;
+                via = gr.adj[j];
+            }
+        }
+        if (best == dist[u * n + i] && via == hop[u * n + i]) return;
+        dist[u * n + i] = best;
+        hop[u * n + i] = via;
+        markChanged(u, i);
+    }
+};
+
+// Splits the nodes having a link into areas of about the same size that are connected by their own links, and fills
+// the area of every node (DV_INF for the nodes without a link). Every area grows by breadth first search until it
+// holds its share of the nodes, from a node left next to the previous area, or the lowest node left if there is none
+// The pieces cut off by the areas around them are then merged into their smallest neighboring area, which keeps the
+// areas connected. A network made of small components still gets an area for each. Returns the number of areas
+ll partitionAreas(const Graph &gr, ll numAreas, vector<uint32_t> &area) {
+    ll n = gr.numNodes(), numLinked = 0;
+    for (ll u = 0; u < n; ++u) numLinked += gr.offset[u] != gr.offset[u + 1];
+    ll target = max(1LL, (numLinked + numAreas - 1) / numAreas);
+
+    area.assign(n, DV_INF);
+    vector<vector<uint32_t>> members;
+    ll lowest = 0, seed = -1;
+    while (true) {
+        // The next seed, next to the previous area if possible
+        if (seed == -1) {
+            while (lowest < n && (area[lowest] != DV_INF || gr.offset[lowest] == gr.offset[lowest + 1])) ++lowest;
+            if (lowest == n) break;
+            seed = lowest;
+        }
+
+        uint32_t a = members.size();
+        members.emplace_back(1, seed);
+        vector<uint32_t> &grown = members.back();
+        area[seed] = a;
+        for (size_t q = 0; q < grown.size() && (ll)grown.size() < target; ++q) {
+            for (uint32_t j = gr.offset[grown[q]]; j < gr.offset[grown[q] + 1] && (ll)grown.size() < target; ++j) {
+                uint32_t v = gr.adj[j];
+                if (area[v] != DV_INF) continue;
+                area[v] = a;
+                grown.emplace_back(v);
+            }
+        }
+
+        // The last nodes reached are the likeliest to have neighbors left
+        seed = -1;
+        for (size_t q = grown.size(); q-- > 0 && seed == -1;) {
+            for (uint32_t j = gr.offset[grown[q]]; j < gr.offset[grown[q] + 1]; ++j) {
+                if (area[gr.adj[j]] == DV_INF) {
+                    seed = gr.adj[j];
+                    break;
+                }
+            }
+        }
+    }
+
+    // Merge the pieces smaller than half the share into the smallest area they have a link to
+    for (uint32_t a = 0; a < members.size(); ++a) {
+        if (members[a].empty() || (ll)members[a].size() * 2 >= target) continue;
+        uint32_t into = DV_INF;
+        for (uint32_t u : members[a]) {
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                uint32_t b = area[gr.adj[j]];
+                if (b != a && (into == DV_INF || members[b].size() < members[into].size())) into = b;
+            }
+        }
+        if (into == DV_INF) continue;
+        for (uint32_t u : members[a]) area[u] = into;
+        members[into].insert(members[into].end(), members[a].begin(), members[a].end());
+        vector<uint32_t>().swap(members[a]);
+    }
+
+    // Number the areas left from 0
+    vector<uint32_t> number(members.size(), DV_INF);
+    ll count = 0;
+    for (size_t a = 0; a < members.size(); ++a) {
+        if (!members[a].empty()) number[a] = count++;
+    }
+    for (ll u = 0; u < n; ++u) {
+        if (area[u] != DV_INF) area[u] = number[area[u]];
+    }
+    return count;
+}
+
+// Hierarchical distance vectors. The nodes are split into areas, and every node keeps a full vector of the nodes
+// of its own area, routed over the links inside it, plus a summary vector holding a single route to every other
+// area, which ends at the first node of that area reached (a border node). A route to a node of another area
+// follows the summary to that area, then the vector of the node it enters by. Every node thus keeps as many entries
+// as the nodes of its area plus the areas, instead of all the nodes, at the cost of routes that may be longer
+// Both kinds of vectors are dense and converge with the event-driven routing: the ones of an area over a graph of
+// its own links, and the summaries over the whole graph, where the destinations are the areas
+class AreaDistVec {
+   public:
+    // Constructor, splits the nodes of the graph into about `numAreas` areas. The rows are updated with the given kernel
+    AreaDistVec(const Graph &gr, ll numAreas, RowKernel kernel) : gr{gr}, n{gr.numNodes()}, summary{kernel} {
+        k = partitionAreas(gr, numAreas, area);
+        members.resize(k);
+        local.assign(n, DV_INF);
+        for (ll u = 0; u < n; ++u) {
+            if (area[u] == DV_INF) continue;
+            local[u] = members[area[u]].size();
+            members[area[u]].emplace_back(u);
+        }
+        for (ll a = 0; a < k; ++a) inside.emplace_back(kernel);
+    }
+
+    // The number of areas
+    ll numAreas() const {
+        return k;
+    }
+
+    // The number of nodes of the largest area
+    ll maxAreaSize() const {
+        size_t size = 0;
+        for (const vector<uint32_t> &m : members) size = max(size, m.size());
+        return size;
+    }
+
+    // The number of nodes having a link to another area
+    ll numBorderNodes() const {
+        ll count = 0;
+        for (ll u = 0; u < n; ++u) {
+            for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) {
+                if (area[gr.adj[j]] != area[u]) {
+                    ++count;
+                    break;
+                }
+            }
+        }
+        return count;
+    }
+
+    // The number of entries of the vectors kept by all the nodes, the summaries leaving out the own area of a node
+    ll numEntries() const {
+        ll count = 0;
+        for (const vector<uint32_t> &m : members) count += (ll)m.size() * (ll)m.size() + (ll)m.size() * (k - 1);
+        return count;
+    }
+
+    // Computes the vectors of the areas, shared by `numThreads` threads, then the summaries and the node every
+    // summary route enters its area by. Fills the number of distance vectors sent
+    void route(ll numThreads, ll &numMessages) {
+        vector<ll> areaMessages(k, 0);
+        parallelFor(k, numThreads, [&](ll a, ll) {
+            // The graph of the links inside the area, its nodes numbered in the order of the area
+            const vector<uint32_t> &m = members[a];
+            size_t numInside = 0;
+            for (uint32_t u : m) {
+                for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) numInside += area[gr.adj[j]] == a;
+            }
+            Graph sub;
+            sub.allocate(m.size(), numInside);
+            size_t e = 0;
+            for (size_t i = 0; i < m.size(); ++i) {
+                for (uint32_t j = gr.offset[m[i]]; j < gr.offset[m[i] + 1]; ++j) {
+                    if (area[gr.adj[j]] != a) continue;
+                    sub.adj[e] = local[gr.adj[j]];
+                    sub.weight[e++] = gr.weight[j];
+                }
+                sub.offset[i + 1] = e;
+            }
+
+            // The nodes of an area of its own have no link inside it, but still know themselves
+            vector<ll> updates;
+            initDistVec(m.size(), sub, inside[a]);
+            for (size_t i = 0; i < m.size(); ++i) inside[a].set(i, i, 0, i);
+            eventDistVecRouting(m.size(), sub, inside[a], updates, areaMessages[a]);
+        });
+
+        // Every node knows its own area, the neighbors learn the areas from each other
+        vector<ll> updates;
+        summary.reset(n, k);
+        for (ll u = 0; u < n; ++u) {
+            if (area[u] != DV_INF) summary.set(u, area[u], 0, u);
+        }
+        eventDistVecRouting(n, gr, summary, updates, numMessages);
+        numMessages += accumulate(areaMessages.begin(), areaMessages.end(), 0LL);
+
+        // The node entering the area `b` at the end of the summary route of every node, found by following the next
+        // hops till a node whose entry is known, then given to all the nodes on the way
+        entering.assign(n * k, DV_INF);
+        vector<uint32_t> path;
+        for (ll b = 0; b < k; ++b) {
+            for (ll u = 0; u < n; ++u) {
+                if (area[u] == DV_INF || summary.entry(u, b).first == INF) continue;
+                path.clear();
+                ll x = u;
+                while (area[x] != b && entering[x * k + b] == DV_INF) {
+                    path.emplace_back(x);
+                    x = summary.entry(x, b).second;
+                }
+                uint32_t node = area[x] == b ? x : entering[x * k + b];
+                for (uint32_t y : path) entering[y * k + b] = node;
+            }
+        }
+    }
+
+    // Returns the length of the route from the node `u` to the node `i` (INF if unreachable) and the neighbor to take
+    pair<ll, ll> entry(ll u, ll i) const {
+        if (area[u] == DV_INF || area[i] == DV_INF) return make_pair(INF, -1LL);
+
+        // Inside the area of `u`
+        uint32_t a = area[u], b = area[i];
+        if (a == b) {
+            pair<ll, ll> p = inside[a].entry(local[u], local[i]);
+            return p.first == INF ? p : make_pair(p.first, (ll)members[a][p.second]);
+        }
+
+        // To the area of `i`, then inside it from the node entering it
+        pair<ll, ll> toArea = summary.entry(u, b);
+        if (toArea.first == INF) return toArea;
+        ll e = entering[u * k + b];
+        pair<ll, ll> p = inside[b].entry(local[e], local[i]);
+        return p.first == INF ? p : make_pair(toArea.first + p.first, toArea.second);
+    }
+
+   private:
+    const Graph &gr;
+    ll n;
+
+    // The number of areas, the area of every node and its number inside it, and the nodes of every area
+    ll k;
+    vector<uint32_t> area, local;
+    vector<vector<uint32_t>> members;
+
+    // The vectors of the nodes of every area over its own nodes, and the summaries of all the nodes over the areas
+    vector<DenseDistVec> inside;
+    DenseDistVec summary;
+
+    // The node entering the area `b` at the end of the summary route of the node `u`, at `u * k + b`
+    vector<uint32_t> entering;
+};
+
+// Compares the routes of the Floyd-Warshall algorithm `fw` with the ones `dv` of the distance vector routing
+// Returns the number of pairs of nodes whose distances differ, or whose neighbor to take in either is not the first
+// node of a shortest route. The ties may pick different neighbors, so the neighbors are not compared with each other
+template <typename AllPairs, typename DistVec>
+ll crossCheck(ll numNodes, const Graph &gr, const AllPairs &fw, const DistVec &dv) {
+    ll mismatches = 0;
+    vector<ll> linkWeight(numNodes, INF);
+    for (ll u = 0; u < numNodes; ++u) {
+        // The lightest link from `u` to every neighbor
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) linkWeight[gr.adj[j]] = min(linkWeight[gr.adj[j]], (ll)gr.weight[j]);
+
+        // Whether the neighbor `h` is the first node of a shortest route from `u` to `i`
+        auto isFirstHop = [&](ll i, ll h) {
+            if (i == u) return h == u;
+            return h >= 0 && linkWeight[h] != INF && linkWeight[h] + fw.entry(h, i).first == fw.entry(u, i).first;
+        };
+        for (ll i = 0; i < numNodes; ++i) {
+            pair<ll, ll> a = fw.entry(u, i), b = dv.entry(u, i);
+            if (a.first != b.first || (a.first != INF && (!isFirstHop(i, a.second) || !isFirstHop(i, b.second)))) ++mismatches;
+        }
+
+        for (uint32_t j = gr.offset[u]; j < gr.offset[u + 1]; ++j) linkWeight[gr.adj[j]] = INF;
+    }
+    return mismatches;
+}
+
+// Reads the link events `<u> <v> <newWeight>|down` from the given file ("-" for the standard input) and applies
+// them one by one after the convergence of the protocol, printing the traffic and the time taken to reconverge
+// after every event. Prints the routing tables at the end and fills the stats of the initial convergence
+// followed by the ones of every event
+void runScenario(ll numNodes, const Graph &gr, const NodeTable &nodes, const Options &opts, vector<ExchangeStats> &events) {
+    ifstream inFile;
+    if (opts.scenario != "-") {
+        inFile.open(opts.scenario, ios::in);
+        // If the file was not able to open, exit with failure status
+        if (!inFile) {
+            std::cout << "File '" << opts.scenario << "' could not be opened!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    istream &in = opts.scenario == "-" ? std::cin : inFile;
+
+    // Read all the events first, as their weights bound the longest route
+    vector<tuple<ll, ll, uint32_t>> links;
+    ll maxWeight = 0;
+    for (size_t j = 0; j < gr.numEntries(); ++j) maxWeight = max(maxWeight, (ll)gr.weight[j]);
+    string u, v, w;
+    while (in >> u >> v >> w) {
+        ll wl = DV_INF;
+        if (w != "down") {
+            try {
+                // Try converting weight to long long integer
+                wl = stringToLong(w);
+
+                // For this question weight should be a positive integer less than 100000
+                if (wl <= 0 || wl >= MAX_EDGE_WEIGHT) throw exception();
+            } catch (exception &e) {
+                std::cout << "The weight of an edge between two nodes should be a positive integer less than 100,000 or 'down', but got '" << w << "'\n";
+                exit(EXIT_FAILURE);
+            }
+            maxWeight = max(maxWeight, wl);
+        }
+        ll ui = nodes.find(u), vi = nodes.find(v);
+        if (ui == -1 || vi == -1) {
+            std::cout << "There is no link between the nodes '" << u << "' and '" << v << "' in the network\n";
+            exit(EXIT_FAILURE);
+        }
+        links.emplace_back(ui, vi, wl);
+    }
+    // The events may make the routes longer than the shortest ones of the network as read
+    ll bound = distanceBound(gr, maxWeight, true);
+
+    // Converge from scratch with the triggered updates before the first event
+    DvProtocol protocol(gr, bound + 1, opts.splitHorizon, opts.poisonReverse);
+    events.assign(1, ExchangeStats());
+    protocol.converge(events[0]);
+
+    auto print = [&](const string &event, const ExchangeStats &stats) {
+        std::cout << event << ": converged in " << stats.rounds << " rounds, " << stats.messages << " updates, " << stats.entries << " entries, " << stats.bytes << " bytes, " << stats.micros << " us\n";
+    };
+    std::cout << "\n";
+    print("Initial", events[0]);
+    for (auto &[ui, vi, wl] : links) {
+        events.emplace_back();
+        auto start = chrono::steady_clock::now();
+        if (!protocol.setCost(ui, vi, wl, events.back())) {
+            std::cout << "There is no link between the nodes '" << nodes.name(ui) << "' and '" << nodes.name(vi) << "' in the network\n";
+            exit(EXIT_FAILURE);
+        }
+        protocol.converge(events.back());
+        events.back().micros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+        string event = "Link " + string(nodes.name(ui)) + " - " + string(nodes.name(vi)) + (wl == DV_INF ? " down" : " to weight " + to_string(wl));
+        print(event, events.back());
+    }
+
+    std::cout << "\nRouting tables after the link events\n\n";
+    printResults(numNodes, nodes, protocol);
+}
+
+// Runs the distance vector protocol over UDP sockets on the loopback with `opts.threads` worker threads,
+// then prints the time to converge, the traffic and the routing tables. Fills `stats` with the traffic
+void runEmulation(ll numNodes, const Graph &gr, const NodeTable &nodes, const Options &opts, ExchangeStats &stats) {
+    DvEmulator emulator(gr, distanceBound(gr, 0, false) + 1, opts);
+    emulator.run(opts.threads, stats);
+
+    double seconds = max(stats.micros, 1LL) / 1e6;
+    std::cout << "Emulation converged in " << stats.micros << " us, " << stats.messages << " datagrams, " << stats.entries << " entries, " << stats.bytes << " bytes, ";
+    std::cout << (ll)(stats.messages / seconds) << " datagrams/s\n\n";
+    printResults(numNodes, nodes, emulator);
+}
+
+// The cost of the area routing: the state kept by the nodes and the stretch of its routes,
+// the length of a route divided by the length of the shortest one
+class AreaStats {
+   public:
+    // The number of areas and of the nodes having a link to another area
+    ll areas = 0, borderNodes = 0;
+
+    // The entries of the vectors kept by all the nodes, and the ones the flat vectors would take
+    ll entries = 0, flatEntries = 0;
+
+    // The routes compared, and the ones longer than the shortest
+    ll routes = 0, stretched = 0;
+
+    // The mean and the largest stretch of the routes compared
+    double meanStretch = 1, maxStretch = 1;
+};
+
+// Runs the area routing with about `opts.areas` areas, then prints the state saved compared with the flat vectors,
+// the stretch of the routes and the routing tables. The stretch is measured from up to AREA_STRETCH_SOURCES nodes
+// spread evenly, whose shortest routes are found one at a time so that they take no more memory than the areas
+void runAreas(ll numNodes, const Graph &gr, const NodeTable &nodes, const Options &opts, AreaStats &stats, ll &numMessages, PhaseTimer &timer) {
+    distanceBound(gr, 0, false);
+    AreaDistVec areas(gr, opts.areas, opts.rowKernel);
+    areas.route(opts.threads, numMessages);
+    timer.lap("route");
+
+    ll numLinked = 0;
+    for (ll u = 0; u < numNodes; ++u) numLinked += gr.offset[u] != gr.offset[u + 1];
+    stats.areas = areas.numAreas();
+    stats.borderNodes = areas.numBorderNodes();
+    stats.entries = areas.numEntries();
+    stats.flatEntries = numLinked * numLinked;
+
+    // Every thread sums the stretch of the routes from its sources
+    ll step = max(1LL, (numNodes + AREA_STRETCH_SOURCES - 1) / AREA_STRETCH_SOURCES);
+    vector<AreaStats> threadStats(opts.threads);
+    vector<double> sums(opts.threads, 0);
+    parallelFor((numNodes + step - 1) / step, opts.threads, [&](ll idx, ll t) {
+        static thread_local vector<ll> dist;
+        static thread_local vector<uint32_t> reached;
+        ll s = idx * step;
+        if (gr.offset[s] == gr.offset[s + 1]) return;
+        dist.assign(numNodes, INF);
+        shortestDistances(gr, s, dist, reached);
+        for (ll i = 0; i < numNodes; ++i) {
+            if (i == s || dist[i] == INF) continue;
+            double stretch = (double)areas.entry(s, i).first / dist[i];
+            ++threadStats[t].routes;
+            threadStats[t].stretched += stretch > 1;
+            threadStats[t].maxStretch = max(threadStats[t].maxStretch, stretch);
+            sums[t] += stretch;
+        }
+    });
+    for (ll t = 0; t < opts.threads; ++t) {
+        stats.routes += threadStats[t].routes;
+        stats.stretched += threadStats[t].stretched;
+        stats.maxStretch = max(stats.maxStretch, threadStats[t].maxStretch);
+    }
+    if (stats.routes > 0) stats.meanStretch = accumulate(sums.begin(), sums.end(), 0.0) / stats.routes;
+    timer.lap("stretch");
+
+    // Every entry holds a 32-bit distance and a 32-bit next hop
+    std::cout << "Areas: " << stats.areas << ", largest " << areas.maxAreaSize() << " nodes, " << stats.borderNodes << " border nodes\n";
+    std::cout << "Routing state: " << stats.entries << " entries (" << stats.entries * 8 << " bytes) instead of " << stats.flatEntries << " entries (" << stats.flatEntries * 8 << " bytes) of the flat vectors, ";
+    std::cout << fixed << setprecision(1) << (stats.flatEntries == 0 ? 0 : 100.0 * (stats.flatEntries - stats.entries) / stats.flatEntries) << "% saved\n";
+    std::cout << "Path stretch over " << stats.routes << " routes: mean " << setprecision(4) << stats.meanStretch << ", max " << stats.maxStretch << ", ";
+    std::cout << setprecision(1) << (stats.routes == 0 ? 0 : 100.0 * stats.stretched / stats.routes) << "% longer than the shortest\n\n";
+    std::cout << defaultfloat << setprecision(6);
+    printResults(numNodes, nodes, areas);
+    std::cout.flush();
+    timer.lap("print");
+}
+
+// Returns the name of the given routing mode
+string routingModeName(RoutingMode mode) {
+    return mode == RoutingMode::SYNC ? "sync" : mode == RoutingMode::EVENTS ? "events" : mode == RoutingMode::FLOYD ? "floyd" : mode == RoutingMode::EMULATE ? "emulate" : mode == RoutingMode::AREAS ? "areas" : "random";
+}
+
+// Writes the time of every phase, the peak resident memory, the number of updates of every iteration,
+// the number of messages exchanged, the traffic of the link events and of the emulation, and the cost of the areas
+// as a single JSON object to the file given with --stats, or to the standard error
+void writeStats(const Options &opts, const PhaseTimer &timer, const vector<ll> &updates, ll numMessages, const vector<ExchangeStats> &events, const ExchangeStats &emulation,
+                const AreaStats &areas) {
+    ofstream outFile;
+    if (opts.statsFile != "-") {
+        outFile.open(opts.statsFile, ios::out | ios::trunc);
+        if (!outFile) {
+            std::cout << "File '" << opts.statsFile << "' could not be opened for writing!\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    ostream &os = opts.statsFile == "-" ? std::cerr : outFile;
+
+    // The peak resident set size of the process, in kilobytes on Linux
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    os << "{\"program\": \"Q2\", ";
+    timer.json(os);
+    os << ", \"layout\": \"" << (opts.sparse ? "sparse" : "dense") << "\", \"mode\": \"" << routingModeName(opts.mode) << "\", \"simd\": \"" << rowKernelName(opts.rowKernel) << "\"";
+    os << ", \"peak_rss_kb\": " << usage.ru_maxrss << ", \"iterations\": " << updates.size() << ", \"messages\": " << numMessages << ", \"updates_per_iteration\": [";
+    for (size_t i = 0; i < updates.size(); ++i) os << (i == 0 ? "" : ", ") << updates[i];
+    os << "], \"link_events\": [";
+    for (size_t i = 0; i < events.size(); ++i) {
+        os << (i == 0 ? "" : ", ") << "{\"rounds\": " << events[i].rounds << ", \"updates\": " << events[i].messages << ", \"entries\": " << events[i].entries;
+        os << ", \"bytes\": " << events[i].bytes << ", \"us\": " << events[i].micros << "}";
+    }
+    os << "]";
+    if (opts.mode == RoutingMode::EMULATE) {
+        os << ", \"emulation\": {\"datagrams\": " << emulation.messages << ", \"entries\": " << emulation.entries << ", \"bytes\": " << emulation.bytes;
+        os << ", \"us\": " << emulation.micros << "}";
+    }
+    if (opts.mode == RoutingMode::AREAS) {
+        os << ", \"areas\": {\"count\": " << areas.areas << ", \"border_nodes\": " << areas.borderNodes << ", \"entries\": " << areas.entries << ", \"flat_entries\": " << areas.flatEntries;
+        os << ", \"routes\": " << areas.routes << ", \"stretched_routes\": " << areas.stretched << ", \"mean_stretch\": " << areas.meanStretch << ", \"max_stretch\": " << areas.maxStretch << "}";
+    }
+    os << "}\n";
+}
+
+// Separates the `--name=value` options from the positional arguments of the command line
+// and fills the options. Exits with failure status on an unknown or invalid option
+void parseOptions(int argc, char const *argv[], Options &opts, vector<string> &args) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        // Every argument not starting with `--` is a positional argument
+        if (arg.rfind("--", 0) != 0) {
+            args.emplace_back(arg);
+            continue;
+        }
+
+        // Split the option into its name and value
+        size_t eq = arg.find('=');
+        string name = arg.substr(2, eq == string::npos ? string::npos : eq - 2);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+        if (name == "timing" && value.empty()) {
+            opts.timing = true;
+        } else if (name == "stats") {
+            opts.stats = true;
+            if (!value.empty()) opts.statsFile = value;
+        } else if (name == "sync" && value.empty()) {
+            opts.mode = RoutingMode::SYNC;
+        } else if (name == "events" && value.empty()) {
+            opts.mode = RoutingMode::EVENTS;
+        } else if (name == "floyd" && value.empty()) {
+            opts.mode = RoutingMode::FLOYD;
+        } else if (name == "emulate" && value.empty()) {
+            opts.mode = RoutingMode::EMULATE;
+        } else if (name == "cross-check" && value.empty()) {
+            opts.crossCheck = true;
+        } else if (name == "seed" || name == "runs") {
+            try {
+                ll number = stringToLong(value);
+                if (number < 0 || number > UINT32_MAX || (name == "runs" && number == 0)) throw exception();
+                if (name == "seed") {
+                    opts.seeded = true;
+                    opts.seed = number;
+                } else {
+                    opts.runs = number;
+                }
+            } catch (exception &e) {
+                std::cout << "Option '" << arg << "' should have a non-negative 32-bit integer value (the runs positive)\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (name == "scenario" && !value.empty()) {
+            opts.scenario = value;
+        } else if (name == "split-horizon" && value.empty()) {
+            opts.splitHorizon = true;
+        } else if (name == "poison-reverse" && value.empty()) {
+            opts.poisonReverse = true;
+        } else if (name == "sparse" && value.empty()) {
+            opts.sparse = true;
+        } else if (name == "simd" && value == "auto") {
+            opts.rowKernel = RowKernel::AUTO;
+        } else if (name == "simd" && value == "scalar") {
+            opts.rowKernel = RowKernel::SCALAR;
+        } else if (name == "simd" && value == "sse4") {
+            opts.rowKernel = RowKernel::SSE4;
+        } else if (name == "simd" && value == "avx2") {
+            opts.rowKernel = RowKernel::AVX2;
+        } else if (name == "save-snapshot" && !value.empty()) {
+            opts.saveSnapshot = value;
+        } else if (name == "verify-snapshot" && value.empty()) {
+            opts.verifySnapshot = true;
+        } else if (name == "areas") {
+            try {
+                opts.mode = RoutingMode::AREAS;
+                opts.areas = stringToLong(value);
+                if (opts.areas <= 0 || opts.areas > UINT32_MAX) throw exception();
+            } catch (exception &e) {
+                std::cout << "Number of areas should be a positive 32-bit integer, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else if (name == "threads") {
+            try {
+                opts.threads = stringToLong(value);
+                if (opts.threads <= 0) throw exception();
+            } catch (exception &e) {
+                std::cout << "Number of threads should be a positive integer, got '" << value << "'\n";
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            std::cout << "Unknown option '" << arg << "'\n";
+            std::cout << "Supported options are: --threads=<n> --sync|--events|--floyd|--emulate|--areas=<k> --cross-check --seed=<s> --runs=<n> --scenario=<file> --split-horizon --poison-reverse --sparse --simd=auto|scalar|sse4|avx2 --save-snapshot=<file> --verify-snapshot --timing --stats[=<file>]\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    // Timing the phases of the run from the start
+    PhaseTimer timer;
+
+    // Separating the options from the arguments
+    Options opts;
+    vector<string> args;
+    parseOptions(argc, argv, opts, args);
+
+    // Picking the kernel updating the distance vectors for the processor running the program
+    opts.rowKernel = resolveRowKernel(opts.rowKernel);
+
+    // Only the random routing depends on the seed, and the study prints no routing table to apply link events to
+    if (opts.runs > 0 && (opts.mode != RoutingMode::RANDOM || !opts.scenario.empty())) {
+        std::cout << "Option --runs=<n> studies the random routing, so it cannot be used with --sync, --events, --floyd, --emulate, --areas=<k> or --scenario=<file>\n";
+        return EXIT_FAILURE;
+    }
+
+    // The Floyd-Warshall algorithm works on the dense matrices, and only its routes are cross-checked
+    if (opts.mode == RoutingMode::FLOYD && opts.sparse) {
+        std::cout << "Option --floyd cannot be used with --sparse\n";
+        return EXIT_FAILURE;
+    }
+    // The protocol applying the link events keeps dense tables, whose size --sparse is meant to avoid
+    if (!opts.scenario.empty() && opts.sparse) {
+        std::cout << "Option --scenario=<file> cannot be used with --sparse\n";
+        return EXIT_FAILURE;
+    }
+    // The emulation and the areas keep their own dense tables and print them before any link event could be applied
+    if ((opts.mode == RoutingMode::EMULATE || opts.mode == RoutingMode::AREAS) && (opts.sparse || !opts.scenario.empty())) {
+        std::cout << "Options --emulate and --areas=<k> cannot be used with --sparse or --scenario=<file>\n";
+        return EXIT_FAILURE;
+    }
+    if (opts.crossCheck && opts.mode != RoutingMode::FLOYD) {
+        std::cout << "Option --cross-check requires --floyd\n";
+        return EXIT_FAILURE;
+    }
+
+    // This program requires two arguments from the command line
+    if (args.size() != 2) {
+        std::cout << "Expected 2 arguments, but received " << args.size() << "\n";
+        std::cout << "Please provide the arguments as follows: ./<prog_name.out> [--threads=<n>] [--sync|--events|--floyd|--emulate|--areas=<k>] [--cross-check] [--seed=<s>] [--runs=<n>] [--scenario=<file>] [--split-horizon] [--poison-reverse] [--sparse] [--simd=auto|scalar|sse4|avx2] [--save-snapshot=<file>] [--verify-snapshot] [--timing] [--stats[=<file>]] <numNodes> <fileName>\n";
+        std::cout << "where <fileName> is a text file of edges or a snapshot saved with --save-snapshot=<file>";
+        return EXIT_FAILURE;
+    }
+
+    // Getting the number of nodes in the network
+    ll numNodes;
+    try {
+        numNodes = stringToLong(args[0]);
+        if (numNodes <= 0) throw exception();
+    } catch (exception &e) {
+        std::cout << "Number of nodes should be provided as a positive integer, got '" << args[0] << "'\n";
+        return EXIT_FAILURE;
+    }
+
+    string fileName = args[1];  // The filename containing edges information
+
+    // Reading the graph from the edges or the snapshot in the file
+    // The graph is declared first, as the names of the nodes may be views into its snapshot
+    Graph graph;
+    NodeTable nodes;
+    loadGraph(numNodes, fileName, opts, nodes, graph, timer);
+
+    // Initializing, executing and printing the Distance Vector Routing algorithm over the chosen layout
+    vector<ll> updates;
+    ll numMessages = 0;
+    ExchangeStats emulation;
+    AreaStats areaStats;
+    uint32_t seed = opts.seeded ? opts.seed : random_device()();
+    auto run = [&](auto &distVec, auto &spare) {
+        // Initializing the distance vector for all the nodes
+        initDistVec(numNodes, graph, distVec);
+        timer.lap("init");
+
+        // Executing the Distance Vector Routing algorithm
+        if (opts.mode == RoutingMode::SYNC) {
+            syncDistVecRouting(numNodes, graph, opts.threads, distVec, spare, updates, numMessages);
+        } else if (opts.mode == RoutingMode::EVENTS) {
+            eventDistVecRouting(numNodes, graph, distVec, updates, numMessages);
+        } else if (opts.mode == RoutingMode::FLOYD) {
+            // Only the dense layout is allowed with it
+            if constexpr (is_same_v<decay_t<decltype(distVec)>, DenseDistVec>) distVec.floydWarshall(graph, opts.threads);
+        } else {
+            distVecRouting(numNodes, graph, seed, distVec, updates, numMessages);
+        }
+        timer.lap("route");
+
+        if (opts.mode != RoutingMode::FLOYD) {
+            std::cout << "Number of iterations for convergence: " << updates.size() << "\n";
+            if (opts.mode == RoutingMode::EVENTS) std::cout << "Number of messages exchanged: " << numMessages << "\n";
+            std::cout << "\n";
+        }
+
+        // Printing the results obtained
+        printResults(numNodes, nodes, distVec);
+        std::cout.flush();
+        timer.lap("print");
+
+        // Comparing with the event-driven routing, which is deterministic and the fastest to converge
+        if (opts.crossCheck) {
+            vector<ll> spareUpdates;
+            ll spareMessages;
+            initDistVec(numNodes, graph, spare);
+            eventDistVecRouting(numNodes, graph, spare, spareUpdates, spareMessages);
+            std::cout << "\nCross-check against the distance vector routing: " << crossCheck(numNodes, graph, distVec, spare) << " mismatched routes\n";
+            timer.lap("cross-check");
+        }
+    };
+    if (opts.runs > 0) {
+        // Every thread runs on its own vectors
+        ll numThreads = min(opts.threads, opts.runs);
+        if (opts.sparse) {
+            vector<SparseDistVec> tables(numThreads);
+            convergenceStudy(numNodes, graph, opts, seed, tables);
+        } else {
+            vector<DenseDistVec> tables;
+            for (ll t = 0; t < numThreads; ++t) tables.emplace_back(opts.rowKernel);
+            convergenceStudy(numNodes, graph, opts, seed, tables);
+        }
+        timer.lap("route");
+    } else if (opts.mode == RoutingMode::EMULATE) {
+        runEmulation(numNodes, graph, nodes, opts, emulation);
+        std::cout.flush();
+        timer.lap("emulate");
+    } else if (opts.mode == RoutingMode::AREAS) {
+        runAreas(numNodes, graph, nodes, opts, areaStats, numMessages, timer);
+    } else if (opts.sparse) {
+        SparseDistVec distVec, spare;
+        run(distVec, spare);
+    } else {
+        DenseDistVec distVec(opts.rowKernel), spare(opts.rowKernel);
+        run(distVec, spare);
+    }
+
+    // Applying the link events after the convergence
+    vector<ExchangeStats> events;
+    if (!opts.scenario.empty()) {
+        runScenario(numNodes, graph, nodes, opts, events);
+        std::cout.flush();
+        timer.lap("scenario");
+    }
 
-    // Printing the results obtained
-    printResults(intToNode, distVec);
+    // Reporting the time taken by every phase
+    if (opts.timing) timer.report(std::cerr);
+    if (opts.stats) writeStats(opts, timer, updates, numMessages, events, emulation, areaStats);
 
     return EXIT_SUCCESS;
 }
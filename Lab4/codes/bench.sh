@@ -0,0 +1,69 @@
+#!/bin/bash
+# Script to time the phases of Q1 and Q2 over the synthetic topologies written by gen.cpp
+# Prints one CSV row per run with the time of every phase in microseconds, so that the runs can be compared over time
+# Usage: ./bench.sh [<numNodes>...] > results.csv
+# The settings below can be overridden from the environment, e.g. THREAD_COUNTS="1 2 4 8" ./bench.sh 1000000
+
+TOPOLOGIES=${TOPOLOGIES:-"grid er ba geometric"} # The topologies to generate
+THREAD_COUNTS=${THREAD_COUNTS:-"1 $(nproc)"}     # The numbers of threads to run the programs with
+RUNS=${RUNS:-1}                                  # The number of runs of every configuration
+DEGREE=${DEGREE:-4}                              # The average degree of the nodes
+SEED=${SEED:-1}                                  # The seed of the generator
+Q1_FLAGS=${Q1_FLAGS:-""}                         # Extra options of Q1, like --kernel=delta
+Q2_MAX_NODES=${Q2_MAX_NODES:-2000}               # Q2 keeps a distance vector of every node, so it runs only on the small topologies
+CXX=${CXX:-g++}                                  # The compiler
+CXXFLAGS=${CXXFLAGS:-"-O2 -std=c++17 -pthread"}  # The flags of the compiler
+PHASES="parse build init route print"            # The phases reported as the columns, in this order
+
+# The number of nodes of the topologies
+SIZES=${*:-"1000 10000 100000"}
+
+# The directory of the sources, and a scratch directory for the programs and the topologies
+SRC_DIR=$(dirname "$0")
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+# Compile the generator and both the programs
+for prog in gen Q1 Q2; do
+    if ! ${CXX} ${CXXFLAGS} -o "${WORK_DIR}/${prog}" "${SRC_DIR}/${prog}.cpp"; then
+        echo "Could not compile ${prog}.cpp" >&2
+        exit 1
+    fi
+done
+
+# Function that runs a program with the given arguments and prints the CSV columns of its phase times
+# followed by their total, the phases missing from the run being left empty
+function timePhases {
+    # The phase times printed by the program on the standard error with --timing
+    timing=$("$@" --timing 2>&1 >/dev/null)
+
+    columns=""
+    total=0
+    for phase in ${PHASES}; do
+        us=$(echo "${timing}" | awk -v p="${phase}:" '$1 == "Phase" && $2 == p { print $3 }')
+        columns="${columns},${us}"
+        total=$((total + ${us:-0}))
+    done
+    echo "${columns},${total}"
+}
+
+echo "program,topology,nodes,edges,threads,run,parse_us,build_us,init_us,route_us,print_us,total_us"
+for topology in ${TOPOLOGIES}; do
+    for n in ${SIZES}; do
+        # Generate the topology once for all the runs
+        edgeFile="${WORK_DIR}/${topology}_${n}.txt"
+        "${WORK_DIR}/gen" --seed="${SEED}" --degree="${DEGREE}" "${topology}" "${n}" >"${edgeFile}" 2>/dev/null
+        edges=$(wc -l <"${edgeFile}")
+
+        for threads in ${THREAD_COUNTS}; do
+            for run in $(seq 1 "${RUNS}"); do
+                prefix="${topology},${n},${edges},${threads},${run}"
+                echo "Q1,${prefix}$(timePhases "${WORK_DIR}/Q1" --threads="${threads}" ${Q1_FLAGS} "${n}" N0 "${edgeFile}")"
+                if [[ ${n} -le ${Q2_MAX_NODES} ]]; then
+                    echo "Q2,${prefix}$(timePhases "${WORK_DIR}/Q2" --threads="${threads}" "${n}" "${edgeFile}")"
+                fi
+            done
+        done
+        rm -f "${edgeFile}"
+    done
+done
@@ -0,0 +1,52 @@
+#!/bin/bash
+# Script to check the path view printed by Q1 against the columns of prettyPrint (setw and left), which awk's printf
+# "%-15s" reproduces. The star topologies are large enough for the buffered output to be flushed many times, with
+# names of several lengths, so that columns of every width end up across the flushing point
+# Usage: ./check_output.sh
+# The settings below can be overridden from the environment, e.g. LEAVES=100000 ./check_output.sh
+
+LEAVES=${LEAVES:-40000}                          # The number of leaves of every star
+NAME_WIDTHS=${NAME_WIDTHS:-"5 6 9 10 12 15 18"}  # The lengths of the names of the leaves
+CXX=${CXX:-g++}                                  # The compiler
+CXXFLAGS=${CXXFLAGS:-"-O2 -std=c++17 -pthread"}  # The flags of the compiler
+
+# The directory of the sources, and a scratch directory for the program and the topologies
+SRC_DIR=$(dirname "$0")
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+if ! ${CXX} ${CXXFLAGS} -o "${WORK_DIR}/Q1" "${SRC_DIR}/Q1.cpp"; then
+    echo "Could not compile Q1.cpp" >&2
+    exit 1
+fi
+
+failed=0
+for width in ${NAME_WIDTHS}; do
+    # The hub linked to every leaf, the leaves named `L` followed by zero padded digits up to the width
+    edgeFile="${WORK_DIR}/star_${width}.txt"
+    awk -v n="${LEAVES}" -v w="${width}" 'BEGIN { for (i = 0; i < n; ++i) printf "HUB L%0" (w - 1) "d 1\n", i }' >"${edgeFile}"
+
+    # The path view as prettyPrint would pad it, the hub first and then the leaves in the order of the file
+    awk -v n="${LEAVES}" -v w="${width}" 'BEGIN {
+        printf "Distance of Nodes from the source node: HUB\n\n"
+        printf "%-15s  |  %-15s  |  Shortest Path\n", "Node", "Path Price"
+        for (i = 0; i < 74; ++i) printf "="
+        printf "\n%-15s  |  %-15s  |  HUB\n", "HUB", 0
+        for (i = 0; i < n; ++i) {
+            name = sprintf("L%0" (w - 1) "d", i)
+            printf "%-15s  |  %-15s  |  HUB -> %s\n", name, 1, name
+        }
+    }' >"${WORK_DIR}/expected.txt"
+
+    "${WORK_DIR}/Q1" $((LEAVES + 1)) HUB "${edgeFile}" >"${WORK_DIR}/actual.txt"
+    if ! cmp -s "${WORK_DIR}/expected.txt" "${WORK_DIR}/actual.txt"; then
+        echo "Path view of the star with names of ${width} characters differs from prettyPrint:" >&2
+        diff "${WORK_DIR}/expected.txt" "${WORK_DIR}/actual.txt" | head -5 >&2
+        failed=1
+    fi
+done
+
+if [[ ${failed} -eq 0 ]]; then
+    echo "The path view matches prettyPrint for all the stars"
+fi
+exit ${failed}
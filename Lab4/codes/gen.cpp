@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using ll = long long;
+
+// Max edge weight accepted by Q1 and Q2
+#define MAX_EDGE_WEIGHT 1e5
+
+// Number of bytes of the output buffered before writing them
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+// Default average degree of the nodes and default largest edge weight
+#define DEFAULT_DEGREE 4
+#define DEFAULT_MAX_WEIGHT 100
+
+// The topologies that can be generated
+enum class Topology {
+    GRID,       // Square grid, every node linked to the nodes to its right and below it
+    ER,         // Erdős–Rényi graph, links between uniformly random pairs of nodes
+    BA,         // Barabási–Albert graph, every new node linked to the existing ones in proportion to their degree
+    GEOMETRIC   // Random geometric graph, nodes at random points of the unit square linked when close enough
+};
+
+// Command line options of the program, given as `--name=value` anywhere among the arguments
+class Options {
+   public:
+    // The seed of the random number generator, the same seed always gives the same topology
+    ll seed = 1;
+
+    // The average degree of the nodes, ignored by the grid
+    ll degree = DEFAULT_DEGREE;
+
+    // The edge weights are in the range 1 to this weight
+    ll maxWeight = DEFAULT_MAX_WEIGHT;
+};
+
+// Takes a string as input and convert it to a long long integer
+// If the string contains non-digit characters, it will throw error
+ll stringToLong(const string &s) {
+    bool isNeg = s[0] == '-';
+    ll res = 0;
+    for (ll i = 0 + isNeg; i < (ll)s.length(); ++i) {
+        if (!isdigit(s[i])) throw exception();
+        res = res * 10 + (s[i] - '0');
+    }
+    if (isNeg) res *= -1;
+    return res;
+}
+
+// Writes the edges as lines `<u> <v> <w>` to the standard output, naming the node `i` as `N<i>`
+// The lines are formatted in place into a large buffer, as the topologies may have tens of millions of edges
+class EdgeWriter {
+   public:
+    // Constructor, the buffer has room for a full line past its flushing point
+    EdgeWriter() : buffer(OUTPUT_BUFFER_SIZE + 64), used{0}, numEdges{0} {}
+
+    // Writes the remaining buffered lines
+    ~EdgeWriter() {
+        flush();
+    }
+
+    // Writes the edge between the nodes `u` and `v` with the given weight
+    void write(ll u, ll v, ll w) {
+        char *p = buffer.data() + used, *end = buffer.data() + buffer.size();
+        *p++ = 'N';
+        p = to_chars(p, end, u).ptr;
+        *p++ = ' ';
+        *p++ = 'N';
+        p = to_chars(p, end, v).ptr;
+        *p++ = ' ';
+        p = to_chars(p, end, w).ptr;
+        *p++ = '\n';
+        used = p - buffer.data();
+        ++numEdges;
+        if (used >= OUTPUT_BUFFER_SIZE) flush();
+    }
+
+    // The number of edges written so far
+    ll count() const {
+        return numEdges;
+    }
+
+   private:
+    vector<char> buffer;
+    size_t used;
+    ll numEdges;
+
+    // Writes the buffered lines to the standard output
+    void flush() {
+        std::cout.write(buffer.data(), used);
+        used = 0;
+    }
+};
+
+// Returns a uniformly random weight of an edge
+ll randomWeight(mt19937_64 &rng, const Options &opts) {
+    return uniform_int_distribution<ll>(1, opts.maxWeight)(rng);
+}
+
+// Square grid of side ceil(sqrt(n)), the last row being partial
+void grid(ll n, const Options &opts, mt19937_64 &rng, EdgeWriter &out) {
+    ll side = ceil(sqrt((double)n));
+    for (ll u = 0; u < n; ++u) {
+        if ((u + 1) % side != 0 && u + 1 < n) out.write(u, u + 1, randomWeight(rng, opts));
+        if (u + side < n) out.write(u, u + side, randomWeight(rng, opts));
+    }
+}
+
+// Erdős–Rényi graph with n * degree / 2 links between uniformly random pairs of distinct nodes
+// Parallel links are rare enough to be left in, both the programs keep them apart
+void erdosRenyi(ll n, const Options &opts, mt19937_64 &rng, EdgeWriter &out) {
+    uniform_int_distribution<ll> node(0, n - 1);
+    for (ll e = 0; e < n * opts.degree / 2; ++e) {
+        ll u = node(rng), v = node(rng);
+        while (v == u) v = node(rng);
+        out.write(u, v, randomWeight(rng, opts));
+    }
+}
+
+// Barabási–Albert graph where every new node links to degree / 2 distinct existing nodes
+// picked with a probability proportional to their degree, starting from a clique
+// The ends of all the links are kept in a list, so picking a uniform entry of it picks a node by its degree
+void barabasiAlbert(ll n, const Options &opts, mt19937_64 &rng, EdgeWriter &out) {
+    ll m = max(1LL, opts.degree / 2);
+    vector<uint32_t> ends;
+    ends.reserve(2 * m * n);
+
+    // The initial clique of m + 1 nodes
+    for (ll u = 0; u <= m && u < n; ++u) {
+        for (ll v = 0; v < u; ++v) {
+            out.write(u, v, randomWeight(rng, opts));
+            ends.push_back(u);
+            ends.push_back(v);
+        }
+    }
+
+    vector<ll> targets;
+    for (ll u = m + 1; u < n; ++u) {
+        targets.clear();
+        while ((ll)targets.size() < m) {
+            ll v = ends[uniform_int_distribution<size_t>(0, ends.size() - 1)(rng)];
+            if (find(targets.begin(), targets.end(), v) == targets.end()) targets.push_back(v);
+        }
+        for (ll v : targets) {
+            out.write(u, v, randomWeight(rng, opts));
+            ends.push_back(u);
+            ends.push_back(v);
+        }
+    }
+}
+
+// Random geometric graph, the radius being chosen so that the nodes have the given average degree
+// The unit square is split into cells as wide as the radius, so only the nodes of the neighboring cells
+// are compared. The weight of a link grows with its length, from 1 to the largest weight at the radius
+void geometric(ll n, const Options &opts, mt19937_64 &rng, EdgeWriter &out) {
+    double radius = sqrt(opts.degree / (M_PI * n));
+    ll cellsPerSide = max(1LL, (ll)(1 / radius));
+
+    // The random points and the cell of every node
+    uniform_real_distribution<double> coord(0, 1);
+    vector<double> x(n), y(n);
+    vector<ll> cellOf(n), cellStart(cellsPerSide * cellsPerSide + 1, 0);
+    for (ll u = 0; u < n; ++u) {
+        x[u] = coord(rng);
+        y[u] = coord(rng);
+        ll cx = min(cellsPerSide - 1, (ll)(x[u] * cellsPerSide)), cy = min(cellsPerSide - 1, (ll)(y[u] * cellsPerSide));
+        cellOf[u] = cy * cellsPerSide + cx;
+        ++cellStart[cellOf[u] + 1];
+    }
+
+    // The nodes and their points in the order of the cells, so that the points compared are close in the memory
+    for (size_t c = 1; c < cellStart.size(); ++c) cellStart[c] += cellStart[c - 1];
+    vector<uint32_t> cellNodes(n);
+    vector<double> cellX(n), cellY(n);
+    vector<ll> next(cellStart.begin(), cellStart.end() - 1);
+    for (ll u = 0; u < n; ++u) {
+        ll k = next[cellOf[u]]++;
+        cellNodes[k] = u;
+        cellX[k] = x[u];
+        cellY[k] = y[u];
+    }
+    vector<double>().swap(x);
+    vector<double>().swap(y);
+
+    // Link every node to the close enough nodes with a larger number in its cell and the eight cells around it
+    for (ll cy = 0; cy < cellsPerSide; ++cy) {
+        for (ll cx = 0; cx < cellsPerSide; ++cx) {
+            for (ll i = cellStart[cy * cellsPerSide + cx]; i < cellStart[cy * cellsPerSide + cx + 1]; ++i) {
+                for (ll ny = max(0LL, cy - 1); ny <= min(cellsPerSide - 1, cy + 1); ++ny) {
+                    for (ll nx = max(0LL, cx - 1); nx <= min(cellsPerSide - 1, cx + 1); ++nx) {
+                        for (ll k = cellStart[ny * cellsPerSide + nx]; k < cellStart[ny * cellsPerSide + nx + 1]; ++k) {
+                            double dx = cellX[i] - cellX[k], dy = cellY[i] - cellY[k];
+                            if (cellNodes[k] <= cellNodes[i] || dx * dx + dy * dy > radius * radius) continue;
+                            double d = sqrt(dx * dx + dy * dy);
+                            out.write(cellNodes[i], cellNodes[k], 1 + (ll)(d / radius * (opts.maxWeight - 1)));
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Separates the `--name=value` options from the positional arguments of the command line
+// and fills the options. Exits with failure status on an unknown or invalid option
+void parseOptions(int argc, char const *argv[], Options &opts, vector<string> &args) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+
+        // Every argument not starting with `--` is a positional argument
+        if (arg.rfind("--", 0) != 0) {
+            args.emplace_back(arg);
+            continue;
+        }
+
+        // Split the option into its name and value
+        size_t eq = arg.find('=');
+        string name = arg.substr(2, eq == string::npos ? string::npos : eq - 2);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+
+        try {
+            if (name == "seed") {
+                opts.seed = stringToLong(value);
+            } else if (name == "degree") {
+                opts.degree = stringToLong(value);
+                if (opts.degree <= 0) throw exception();
+            } else if (name == "max-weight") {
+                opts.maxWeight = stringToLong(value);
+                if (opts.maxWeight <= 0 || opts.maxWeight >= MAX_EDGE_WEIGHT) throw exception();
+            } else {
+                std::cerr << "Unknown option '" << arg << "'\n";
+                std::cerr << "Supported options are: --seed=<s> --degree=<d> --max-weight=<w>\n";
+                exit(EXIT_FAILURE);
+            }
+        } catch (exception &e) {
+            std::cerr << "Option '" << arg << "' should have a positive integer value (the weight less than 100,000)\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Generates a synthetic topology and writes its edges to the standard output in the input format of Q1 and Q2
+// The nodes are named `N0` to `N<n - 1>`, so `N0` is always a valid source node
+int main(int argc, char const *argv[]) {
+    // Separating the options from the arguments
+    Options opts;
+    vector<string> args;
+    parseOptions(argc, argv, opts, args);
+
+    // This program requires two arguments from the command line
+    if (args.size() != 2) {
+        std::cerr << "Expected 2 arguments, but received " << args.size() << "\n";
+        std::cerr << "Please provide the arguments as follows: ./<prog_name.out> [--seed=<s>] [--degree=<d>] [--max-weight=<w>] grid|er|ba|geometric <numNodes> > <fileName>";
+        return EXIT_FAILURE;
+    }
+
+    Topology topology;
+    if (args[0] == "grid") {
+        topology = Topology::GRID;
+    } else if (args[0] == "er") {
+        topology = Topology::ER;
+    } else if (args[0] == "ba") {
+        topology = Topology::BA;
+    } else if (args[0] == "geometric") {
+        topology = Topology::GEOMETRIC;
+    } else {
+        std::cerr << "Topology should be one of grid, er, ba or geometric, got '" << args[0] << "'\n";
+        return EXIT_FAILURE;
+    }
+
+    // Getting the number of nodes in the network, they should all fit in 32 bits
+    ll numNodes;
+    try {
+        numNodes = stringToLong(args[1]);
+        if (numNodes <= 1 || numNodes >= UINT32_MAX) throw exception();
+    } catch (exception &e) {
+        std::cerr << "Number of nodes should be provided as an integer greater than 1, got '" << args[1] << "'\n";
+        return EXIT_FAILURE;
+    }
+
+    ios::sync_with_stdio(false);
+    mt19937_64 rng(opts.seed);
+    EdgeWriter out;
+    if (topology == Topology::GRID) {
+        grid(numNodes, opts, rng, out);
+    } else if (topology == Topology::ER) {
+        erdosRenyi(numNodes, opts, rng, out);
+    } else if (topology == Topology::BA) {
+        barabasiAlbert(numNodes, opts, rng, out);
+    } else {
+        geometric(numNodes, opts, rng, out);
+    }
+
+    // The summary goes to the standard error, to keep the edge file clean
+    std::cerr << "Generated " << out.count() << " edges over " << numNodes << " nodes\n";
+    return EXIT_SUCCESS;
+}